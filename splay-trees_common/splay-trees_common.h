@@ -0,0 +1,172 @@
+/**
+ * @brief Splay Tree data structure library common definitions.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file contains the definitions shared by all flavours of the library,
+ * i.e. options for all functions, which are the same no matter the type of
+ * the keys. It's included by each flavour's header, so it doesn't need to be
+ * included directly.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef SPLAYTREES_COMMON_H
+#define SPLAYTREES_COMMON_H
+
+#include <pthread.h>
+
+typedef unsigned long int ulong;
+
+/**
+ * These options can be OR'd in a call to the delete functions to specify
+ * if also the keys and/or the data in the nodes must be freed in the heap.
+ * If nothing is specified, only the nodes are freed.
+ */
+#define DELETE_FREE_DATA 0x1
+#define DELETE_FREE_KEYS 0x10000
+
+/**
+ * These options can be specified to tell the search functions what data to
+ * return from the trees.
+ * Only one at a time is allowed.
+ * Nodes returned with SEARCH_NODES keep their key and data until they are
+ * deleted, no matter how many rotations the tree goes through.
+ */
+#define SEARCH_DATA 0x4
+#define SEARCH_KEYS 0x8
+#define SEARCH_NODES 0x10
+
+/**
+ * This option can be used to perform the splaying operation on the target node
+ * during a search. For performance purposes, this behaviour is configurable,
+ * since it can prevent concurrent accesses in multithreaded scenarios.
+ * If set, the amortized analysis result applies and the amortized time for all
+ * types of operations seen in a sequence is logarithmic in the max number of
+ * nodes the structure reaches in a sequence, but searches must be performed
+ * atomically (and locking of the structure is not dealt with here).
+ * If not set, searches have a linear worst-case execution time, but can be
+ * perfomed concurrently by multiple threads.
+ * Can be OR'd with the previous ones.
+ */
+#define SEARCH_SPLAY 0x2
+
+/**
+ * These options can be used to specify the desired kind of depth-first search.
+ * Only one at a time is allowed.
+ */
+#define DFS_PRE_ORDER 0x20
+#define DFS_IN_ORDER 0x40
+#define DFS_POST_ORDER 0x80
+
+/*
+ * These options can be used to specify the desired kind of breadth-first
+ * search. Only one at a time is allowed.
+ */
+#define BFS_LEFT_FIRST 0x100
+#define BFS_RIGHT_FIRST 0x200
+
+/**
+ * These options can be set in a tree's splay_opts field to configure how the
+ * tree is splayed by all operations.
+ * By default, searches, insertions and deletions splay top-down, finding and
+ * splaying the target node with a single descent from the root.
+ * SPLAY_BOTTOM_UP restores the classic behaviour: the target node is first
+ * reached, then splayed back up to the root one rotation step at a time.
+ * Finger searches and range deletions always splay bottom-up (see
+ * splay_finger_search and splay_delete_range).
+ */
+#define SPLAY_BOTTOM_UP 0x400
+
+/**
+ * These options can be set in a tree's splay_opts field, or OR'd in a call to
+ * the search routine together with SEARCH_SPLAY, to cut the rotations done by
+ * splaying searches. Both imply bottom-up splaying, and can be combined.
+ * SPLAY_SEMI enables semi-splaying: the target node is only brought halfway up
+ * to the root, while still halving the length of its access path, so the
+ * amortized analysis results still apply.
+ * SPLAY_DEPTH_LIMIT makes searches splay only target nodes found deeper than
+ * the tree's splay_depth field, which is 0 by default, leaving hot keys close
+ * to the root alone.
+ * Insertions and deletions always splay fully.
+ */
+#define SPLAY_SEMI 0x1000
+#define SPLAY_DEPTH_LIMIT 0x2000
+
+/**
+ * This option can be set in a tree's splay_opts field to make insertions of
+ * new keys evict an entry when the tree already holds max_nodes of them,
+ * instead of failing. The entry evicted is a leaf, found by going on from
+ * where the new key's descent ends down to the bottom of the tree: since
+ * splaying moves the entries that are accessed up to the root, the deepest
+ * ones are those that were accessed least recently.
+ */
+#define SPLAY_EVICT 0x20000
+
+/**
+ * This option can be OR'd in a call to the search routine to rebuild the tree
+ * into a balanced one (see splay_rebalance) if the search reaches deeper than
+ * the tree's rebalance_factor times the base 2 logarithm of its nodes count,
+ * e.g. after many insertions of sequential keys. This modifies the tree, so
+ * such searches must be performed atomically, like splaying ones.
+ * Top-down splaying searches don't check it, since they already shorten the
+ * paths they go through. Trees with fewer than 3 nodes are never rebuilt,
+ * since rebalancing can't shorten their paths. If the tree is rebuilt, depth
+ * limits on splaying apply to the depth of the node found in the new tree.
+ */
+#define SEARCH_REBALANCE 0x40000
+
+/**
+ * These options tell splay_merge what to do with keys found in both trees.
+ * Only one at a time is allowed.
+ * MERGE_KEEP_LEFT keeps the entries of the destination tree.
+ * MERGE_KEEP_RIGHT keeps the entries of the source tree.
+ * MERGE_KEEP_BOTH keeps them all, those of the destination tree first.
+ * The entries that are not kept are deleted, and the options of the delete
+ * functions can be OR'd with these to free their keys and data.
+ */
+#define MERGE_KEEP_LEFT 0x80000
+#define MERGE_KEEP_RIGHT 0x100000
+#define MERGE_KEEP_BOTH 0x200000
+
+/**
+ * This option can be passed to iterators to visit nodes by decreasing keys.
+ */
+#define ITER_REVERSE 0x800
+
+/**
+ * This is the number of keys each access log of a concurrent tree keeps (see
+ * splay-trees_template.h).
+ */
+#define SPLAY_SYNC_LOG_SIZE 32
+
+/**
+ * This is the number of levels the depth histogram of a tree's shape counts
+ * nodes in (see splay-trees_template.h): the last one also counts the deeper
+ * ones.
+ */
+#define SPLAY_SHAPE_DEPTHS 64
+
+/**
+ * These options are given upon the creation of a sharded Splay Tree, which
+ * partitions keys among many concurrent trees (shards) each one with its own
+ * lock, to choose how keys are assigned to shards. Only one at a time is
+ * allowed.
+ * SHARD_BY_RANGE gives each shard a contiguous interval of keys, so that
+ * in-order walks visit one shard after the other, locking one at a time.
+ * SHARD_BY_HASH spreads keys by hashing them, which balances skewed key sets
+ * better, but in-order walks have to lock and merge all shards together.
+ */
+#define SHARD_BY_RANGE 0x4000
+#define SHARD_BY_HASH 0x8000
+
+/* Token pasting for flavours' names, which expands its arguments first. */
+#define SPL_PASTE(a, b) _SPL_PASTE(a, b)
+#define _SPL_PASTE(a, b) a##b
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * @brief Splay Tree data structure library template names.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file maps the generic names of all types and functions in the
+ * template to the ones of a flavour, built from the prefixes it defines
+ * (see splay-trees_template.h). It's meant to be included only by flavours'
+ * headers, and has no include guard on purpose.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+/* Types. */
+#define SplayNode SPL_PASTE(SPL_TYPE_PREFIX, Node)
+#define SplayTree SPL_PASTE(SPL_TYPE_PREFIX, Tree)
+#define SplayChunk SPL_PASTE(SPL_TYPE_PREFIX, Chunk)
+#define SplayPool SPL_PASTE(SPL_TYPE_PREFIX, Pool)
+#define SplaySyncTree SPL_PASTE(SPL_TYPE_PREFIX, SyncTree)
+#define SplayShardTree SPL_PASTE(SPL_TYPE_PREFIX, ShardTree)
+#define SplayShardIter SPL_PASTE(SPL_TYPE_PREFIX, ShardIter)
+#define SplayCompactTree SPL_PASTE(SPL_TYPE_PREFIX, CompactTree)
+#define SplayCompactNode SPL_PASTE(SPL_TYPE_PREFIX, CompactNode)
+#define SplayStats SPL_PASTE(SPL_TYPE_PREFIX, Stats)
+#define SplayPoolConfig SPL_PASTE(SPL_TYPE_PREFIX, PoolConfig)
+#define SplayIter SPL_PASTE(SPL_TYPE_PREFIX, Iter)
+#define SplayCallback SPL_PASTE(SPL_TYPE_PREFIX, Callback)
+#define SplayAccessLog SPL_PASTE(SPL_TYPE_PREFIX, AccessLog)
+
+#define SplaySnapshot SPL_PASTE(SPL_TYPE_PREFIX, Snapshot)
+#define SplayWalk SPL_PASTE(SPL_TYPE_PREFIX, Walk)
+#define SplayFrozen SPL_PASTE(SPL_TYPE_PREFIX, Frozen)
+#define SplayShape SPL_PASTE(SPL_TYPE_PREFIX, Shape)
+/* Structure tags. */
+#define _splay_node SPL_PASTE(_, SPL_PASTE(SPL_FUNC_PREFIX, _node))
+#define _splay_chunk SPL_PASTE(_, SPL_PASTE(SPL_FUNC_PREFIX, _chunk))
+#define _splay_access_log SPL_PASTE(_, SPL_PASTE(SPL_FUNC_PREFIX, _access_log))
+#define _splay_sync_tree SPL_PASTE(_, SPL_PASTE(SPL_FUNC_PREFIX, _sync_tree))
+
+/* Library functions. */
+#define create_splay_tree SPL_PASTE(create_, SPL_PASTE(SPL_FUNC_PREFIX, _tree))
+#define create_splay_tree_ex \
+    SPL_PASTE(create_, SPL_PASTE(SPL_FUNC_PREFIX, _tree_ex))
+#define create_splay_sync_tree \
+    SPL_PASTE(create_, SPL_PASTE(SPL_FUNC_PREFIX, _sync_tree))
+#define create_splay_shard_tree \
+    SPL_PASTE(create_, SPL_PASTE(SPL_FUNC_PREFIX, _shard_tree))
+#define create_splay_compact_tree \
+    SPL_PASTE(create_, SPL_PASTE(SPL_FUNC_PREFIX, _compact_tree))
+#define delete_splay_tree SPL_PASTE(delete_, SPL_PASTE(SPL_FUNC_PREFIX, _tree))
+#define delete_splay_sync_tree \
+    SPL_PASTE(delete_, SPL_PASTE(SPL_FUNC_PREFIX, _sync_tree))
+#define delete_splay_shard_tree \
+    SPL_PASTE(delete_, SPL_PASTE(SPL_FUNC_PREFIX, _shard_tree))
+#define delete_splay_compact_tree \
+    SPL_PASTE(delete_, SPL_PASTE(SPL_FUNC_PREFIX, _compact_tree))
+#define splay_bfs SPL_PASTE(SPL_FUNC_PREFIX, _bfs)
+#define splay_search SPL_PASTE(SPL_FUNC_PREFIX, _search)
+#define splay_delete SPL_PASTE(SPL_FUNC_PREFIX, _delete)
+#define splay_insert SPL_PASTE(SPL_FUNC_PREFIX, _insert)
+#define splay_dfs SPL_PASTE(SPL_FUNC_PREFIX, _dfs)
+#define splay_build_sorted SPL_PASTE(SPL_FUNC_PREFIX, _build_sorted)
+#define splay_iter_begin SPL_PASTE(SPL_FUNC_PREFIX, _iter_begin)
+#define splay_iter_next SPL_PASTE(SPL_FUNC_PREFIX, _iter_next)
+#define splay_iter_end SPL_PASTE(SPL_FUNC_PREFIX, _iter_end)
+#define splay_range SPL_PASTE(SPL_FUNC_PREFIX, _range)
+#define splay_range_count SPL_PASTE(SPL_FUNC_PREFIX, _range_count)
+#define splay_split SPL_PASTE(SPL_FUNC_PREFIX, _split)
+#define splay_join SPL_PASTE(SPL_FUNC_PREFIX, _join)
+#define splay_sync_search SPL_PASTE(SPL_FUNC_PREFIX, _sync_search)
+#define splay_sync_insert SPL_PASTE(SPL_FUNC_PREFIX, _sync_insert)
+#define splay_sync_delete SPL_PASTE(SPL_FUNC_PREFIX, _sync_delete)
+#define splay_sync_dfs SPL_PASTE(SPL_FUNC_PREFIX, _sync_dfs)
+#define splay_sync_bfs SPL_PASTE(SPL_FUNC_PREFIX, _sync_bfs)
+#define splay_sync_maintain SPL_PASTE(SPL_FUNC_PREFIX, _sync_maintain)
+#define splay_shard_search SPL_PASTE(SPL_FUNC_PREFIX, _shard_search)
+#define splay_shard_count SPL_PASTE(SPL_FUNC_PREFIX, _shard_count)
+#define splay_shard_insert SPL_PASTE(SPL_FUNC_PREFIX, _shard_insert)
+#define splay_shard_delete SPL_PASTE(SPL_FUNC_PREFIX, _shard_delete)
+#define splay_shard_dfs SPL_PASTE(SPL_FUNC_PREFIX, _shard_dfs)
+#define splay_shard_iter_begin SPL_PASTE(SPL_FUNC_PREFIX, _shard_iter_begin)
+#define splay_shard_iter_from SPL_PASTE(SPL_FUNC_PREFIX, _shard_iter_from)
+#define splay_shard_iter_next SPL_PASTE(SPL_FUNC_PREFIX, _shard_iter_next)
+#define splay_shard_iter_end SPL_PASTE(SPL_FUNC_PREFIX, _shard_iter_end)
+#define splay_compact_search SPL_PASTE(SPL_FUNC_PREFIX, _compact_search)
+#define splay_compact_insert SPL_PASTE(SPL_FUNC_PREFIX, _compact_insert)
+#define splay_compact_delete SPL_PASTE(SPL_FUNC_PREFIX, _compact_delete)
+#define splay_compact_dfs SPL_PASTE(SPL_FUNC_PREFIX, _compact_dfs)
+#define splay_stats SPL_PASTE(SPL_FUNC_PREFIX, _stats)
+#define splay_sync_stats SPL_PASTE(SPL_FUNC_PREFIX, _sync_stats)
+#define splay_shard_stats SPL_PASTE(SPL_FUNC_PREFIX, _shard_stats)
+
+#define splay_save SPL_PASTE(SPL_FUNC_PREFIX, _save)
+#define splay_load SPL_PASTE(SPL_FUNC_PREFIX, _load)
+#define splay_compact_save SPL_PASTE(SPL_FUNC_PREFIX, _compact_save)
+#define splay_compact_load SPL_PASTE(SPL_FUNC_PREFIX, _compact_load)
+#define splay_compact_map SPL_PASTE(SPL_FUNC_PREFIX, _compact_map)
+#define splay_clear SPL_PASTE(SPL_FUNC_PREFIX, _clear)
+#define splay_floor SPL_PASTE(SPL_FUNC_PREFIX, _floor)
+#define splay_ceiling SPL_PASTE(SPL_FUNC_PREFIX, _ceiling)
+#define splay_predecessor SPL_PASTE(SPL_FUNC_PREFIX, _predecessor)
+#define splay_successor SPL_PASTE(SPL_FUNC_PREFIX, _successor)
+#define splay_min SPL_PASTE(SPL_FUNC_PREFIX, _min)
+#define splay_max SPL_PASTE(SPL_FUNC_PREFIX, _max)
+#define splay_select SPL_PASTE(SPL_FUNC_PREFIX, _select)
+#define splay_rank SPL_PASTE(SPL_FUNC_PREFIX, _rank)
+#define splay_finger_search SPL_PASTE(SPL_FUNC_PREFIX, _finger_search)
+#define splay_search_batch SPL_PASTE(SPL_FUNC_PREFIX, _search_batch)
+#define splay_insert_batch SPL_PASTE(SPL_FUNC_PREFIX, _insert_batch)
+#define splay_upsert SPL_PASTE(SPL_FUNC_PREFIX, _upsert)
+#define splay_get_or_insert SPL_PASTE(SPL_FUNC_PREFIX, _get_or_insert)
+#define splay_dfs_buf SPL_PASTE(SPL_FUNC_PREFIX, _dfs_buf)
+#define splay_bfs_buf SPL_PASTE(SPL_FUNC_PREFIX, _bfs_buf)
+#define splay_rebalance SPL_PASTE(SPL_FUNC_PREFIX, _rebalance)
+#define splay_merge SPL_PASTE(SPL_FUNC_PREFIX, _merge)
+#define splay_freeze SPL_PASTE(SPL_FUNC_PREFIX, _freeze)
+#define delete_splay_frozen \
+    SPL_PASTE(delete_, SPL_PASTE(SPL_FUNC_PREFIX, _frozen))
+#define splay_frozen_search SPL_PASTE(SPL_FUNC_PREFIX, _frozen_search)
+#define splay_frozen_floor SPL_PASTE(SPL_FUNC_PREFIX, _frozen_floor)
+#define splay_frozen_ceiling SPL_PASTE(SPL_FUNC_PREFIX, _frozen_ceiling)
+#define splay_frozen_range SPL_PASTE(SPL_FUNC_PREFIX, _frozen_range)
+#define splay_delete_range SPL_PASTE(SPL_FUNC_PREFIX, _delete_range)
+#define splay_shape_stats SPL_PASTE(SPL_FUNC_PREFIX, _shape_stats)
+/* Internal library subroutines. */
+#define _spl_stat_max SPL_PASTE(SPL_INTERNAL_PREFIX, _stat_max)
+#define _spl_create_node SPL_PASTE(SPL_INTERNAL_PREFIX, _create_node)
+#define _spl_delete_node SPL_PASTE(SPL_INTERNAL_PREFIX, _delete_node)
+#define _spl_pool_add_chunk SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_add_chunk)
+#define _spl_pool_alloc SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_alloc)
+#define _spl_pool_free SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_free)
+#define _spl_pool_share SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_share)
+#define _spl_pool_absorb SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_absorb)
+#define _spl_pool_release SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_release)
+#define _spl_pool_is_shared SPL_PASTE(SPL_INTERNAL_PREFIX, _pool_is_shared)
+#define _spl_build_balanced SPL_PASTE(SPL_INTERNAL_PREFIX, _build_balanced)
+#define _spl_search_node SPL_PASTE(SPL_INTERNAL_PREFIX, _search_node)
+#define _spl_lower_bound SPL_PASTE(SPL_INTERNAL_PREFIX, _lower_bound)
+#define _spl_floor_bound SPL_PASTE(SPL_INTERNAL_PREFIX, _floor_bound)
+#define _spl_insert_left_subtree \
+    SPL_PASTE(SPL_INTERNAL_PREFIX, _insert_left_subtree)
+#define _spl_insert_right_subtree \
+    SPL_PASTE(SPL_INTERNAL_PREFIX, _insert_right_subtree)
+#define _spl_cut_left_subtree SPL_PASTE(SPL_INTERNAL_PREFIX, _cut_left_subtree)
+#define _spl_cut_right_subtree \
+    SPL_PASTE(SPL_INTERNAL_PREFIX, _cut_right_subtree)
+#define _spl_max_key_son SPL_PASTE(SPL_INTERNAL_PREFIX, _max_key_son)
+#define _spl_min_key_son SPL_PASTE(SPL_INTERNAL_PREFIX, _min_key_son)
+#define _spl_successor SPL_PASTE(SPL_INTERNAL_PREFIX, _successor)
+#define _spl_predecessor SPL_PASTE(SPL_INTERNAL_PREFIX, _predecessor)
+#define _spl_right_rotation SPL_PASTE(SPL_INTERNAL_PREFIX, _right_rotation)
+#define _spl_left_rotation SPL_PASTE(SPL_INTERNAL_PREFIX, _left_rotation)
+#define _spl_splay SPL_PASTE(SPL_INTERNAL_PREFIX, _splay)
+#define _spl_splay_node SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_node)
+#define _spl_splay_subtree SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_subtree)
+#define _spl_semi_splay_node SPL_PASTE(SPL_INTERNAL_PREFIX, _semi_splay_node)
+#define _spl_join SPL_PASTE(SPL_INTERNAL_PREFIX, _join)
+#define _spl_td_splay SPL_PASTE(SPL_INTERNAL_PREFIX, _td_splay)
+#define _spl_td_splay_max SPL_PASTE(SPL_INTERNAL_PREFIX, _td_splay_max)
+#define _spl_td_splay_min SPL_PASTE(SPL_INTERNAL_PREFIX, _td_splay_min)
+#define _spl_splay_max SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_max)
+#define _spl_splay_min SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_min)
+#define _spl_splay_floor SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_floor)
+#define _spl_count_left SPL_PASTE(SPL_INTERNAL_PREFIX, _count_left)
+#define _spl_sync_log_access SPL_PASTE(SPL_INTERNAL_PREFIX, _sync_log_access)
+#define _spl_sync_log_destroy SPL_PASTE(SPL_INTERNAL_PREFIX, _sync_log_destroy)
+#define _spl_sync_apply_logs SPL_PASTE(SPL_INTERNAL_PREFIX, _sync_apply_logs)
+#define _spl_td_join SPL_PASTE(SPL_INTERNAL_PREFIX, _td_join)
+#define _spl_dfs_next SPL_PASTE(SPL_INTERNAL_PREFIX, _dfs_next)
+#define _spl_store_node SPL_PASTE(SPL_INTERNAL_PREFIX, _store_node)
+#define _spl_dfs_fill SPL_PASTE(SPL_INTERNAL_PREFIX, _dfs_fill)
+#define _spl_shard_index SPL_PASTE(SPL_INTERNAL_PREFIX, _shard_index)
+#define _spl_shard_iter_walk SPL_PASTE(SPL_INTERNAL_PREFIX, _shard_iter_walk)
+#define _spl_shard_iter_pick SPL_PASTE(SPL_INTERNAL_PREFIX, _shard_iter_pick)
+#define _spl_compact_alloc SPL_PASTE(SPL_INTERNAL_PREFIX, _compact_alloc)
+#define _spl_compact_grow SPL_PASTE(SPL_INTERNAL_PREFIX, _compact_grow)
+#define _spl_compact_splay SPL_PASTE(SPL_INTERNAL_PREFIX, _compact_splay)
+#define _spl_compact_splay_max \
+    SPL_PASTE(SPL_INTERNAL_PREFIX, _compact_splay_max)
+#define _spl_stats_merge SPL_PASTE(SPL_INTERNAL_PREFIX, _stats_merge)
+#define _spl_write_all SPL_PASTE(SPL_INTERNAL_PREFIX, _write_all)
+#define _spl_read_all SPL_PASTE(SPL_INTERNAL_PREFIX, _read_all)
+#define _spl_snapshot_link SPL_PASTE(SPL_INTERNAL_PREFIX, _snapshot_link)
+#define _spl_snapshot_write SPL_PASTE(SPL_INTERNAL_PREFIX, _snapshot_write)
+#define _spl_snapshot_read SPL_PASTE(SPL_INTERNAL_PREFIX, _snapshot_read)
+#define _spl_free_nodes SPL_PASTE(SPL_INTERNAL_PREFIX, _free_nodes)
+#define _spl_nearest SPL_PASTE(SPL_INTERNAL_PREFIX, _nearest)
+#define _spl_nearest_result SPL_PASTE(SPL_INTERNAL_PREFIX, _nearest_result)
+#define _spl_splay_found SPL_PASTE(SPL_INTERNAL_PREFIX, _splay_found)
+#define _spl_size_fix_path SPL_PASTE(SPL_INTERNAL_PREFIX, _size_fix_path)
+#define _spl_size_fix_all SPL_PASTE(SPL_INTERNAL_PREFIX, _size_fix_all)
+#define _spl_search_from SPL_PASTE(SPL_INTERNAL_PREFIX, _search_from)
+#define _spl_finger_climb SPL_PASTE(SPL_INTERNAL_PREFIX, _finger_climb)
+#define _spl_batch_order SPL_PASTE(SPL_INTERNAL_PREFIX, _batch_order)
+#define _spl_batch_descend SPL_PASTE(SPL_INTERNAL_PREFIX, _batch_descend)
+#define _spl_insert_root SPL_PASTE(SPL_INTERNAL_PREFIX, _insert_root)
+#define _spl_find_or_insert SPL_PASTE(SPL_INTERNAL_PREFIX, _find_or_insert)
+#define _spl_walk_opts SPL_PASTE(SPL_INTERNAL_PREFIX, _walk_opts)
+#define _spl_level_first SPL_PASTE(SPL_INTERNAL_PREFIX, _level_first)
+#define _spl_level_next SPL_PASTE(SPL_INTERNAL_PREFIX, _level_next)
+#define _spl_evict SPL_PASTE(SPL_INTERNAL_PREFIX, _evict)
+#define _spl_tree_to_vine SPL_PASTE(SPL_INTERNAL_PREFIX, _tree_to_vine)
+#define _spl_vine_compress SPL_PASTE(SPL_INTERNAL_PREFIX, _vine_compress)
+#define _spl_floor_log2 SPL_PASTE(SPL_INTERNAL_PREFIX, _floor_log2)
+#define _spl_vine_to_tree SPL_PASTE(SPL_INTERNAL_PREFIX, _vine_to_tree)
+#define _spl_frozen_bound SPL_PASTE(SPL_INTERNAL_PREFIX, _frozen_bound)
+#define _spl_frozen_next SPL_PASTE(SPL_INTERNAL_PREFIX, _frozen_next)
+#define _spl_frozen_prev SPL_PASTE(SPL_INTERNAL_PREFIX, _frozen_prev)
+#define _spl_shape_memory SPL_PASTE(SPL_INTERNAL_PREFIX, _shape_memory)
+#define _spl_shape_walk SPL_PASTE(SPL_INTERNAL_PREFIX, _shape_walk)
+#define _spl_shape_probe SPL_PASTE(SPL_INTERNAL_PREFIX, _shape_probe)
@@ -0,0 +1,4974 @@
+/**
+ * @brief Splay Tree data structure library template source code.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file implements the Splay Tree data structure once for all flavours of
+ * the library. Each flavour's source file includes its header, keeping the
+ * generic names (see splay-trees_template.h), defines the following macros,
+ * then includes this file:
+ * - SPL_KEY_MAKE(arg): key to store in a node, given one passed by the user.
+ * - SPL_KEY_GET(key): key to return to the user, given a stored one.
+ * - SPL_KEY_CMP(a, b): compares two stored keys, returning a negative number,
+ *   zero or a positive number if a is less than, equal to or greater than b.
+ *   Keys must never be subtracted, since that could overflow.
+ * - SPL_KEY_HASH(key): 32-bit unsigned hash of a stored key, for sharding.
+ * - SPL_KEY_FREE(key): frees a stored key from the heap, if DELETE_FREE_KEYS
+ *   is specified upon deletions.
+ * - SPL_KEY_SPLIT(i, n): lower bound of shard i + 1 when the whole range of
+ *   keys is split evenly among n shards. Optional: if it's not defined,
+ *   sharded trees by range require bounds.
+ * This file must not be compiled on its own.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Node pools parameters. */
+#define SPL_CACHE_LINE 64
+#define SPL_POOL_CHUNK_NODES 1024
+
+/* Number of descents interleaved by non-splaying batch searches. */
+#define SPL_BATCH_WIDTH 8
+
+/* Frozen trees' parameters: keys per cache line, i.e. descendants of a key
+ * on a same level below it that share one. */
+#define SPL_FROZEN_LINE_KEYS \
+    ((sizeof(SPL_KEY) < SPL_CACHE_LINE) ? (SPL_CACHE_LINE / sizeof(SPL_KEY)) \
+                                        : 1)
+
+/* Compact trees' parameters. */
+#define SPL_COMPACT_MIN_CAPACITY 16
+#define SPL_COMPACT_MAX_CAPACITY UINT_MAX
+
+/* Snapshots' parameters: data follows nodes, aligned to pointers. */
+#define SPL_SNAPSHOT_MAGIC 0x53504C59U
+#define SPL_SNAPSHOT_DATA_OFFSET(n) \
+    ((sizeof(SplaySnapshot) + ((n) + 1) * sizeof(SplayCompactNode) + \
+      sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+
+/* Chunks' headers are padded to a full cache line, then nodes follow. */
+#define SPL_CHUNK_NODES(chunk) \
+    ((SplayNode *)((char *)(chunk) + SPL_CACHE_LINE))
+/* aligned_alloc requires the size to be a multiple of the alignment. */
+#define SPL_CHUNK_SIZE(capacity) \
+    ((SPL_CACHE_LINE + (size_t)(capacity) * sizeof(SplayNode) + \
+      SPL_CACHE_LINE - 1) & ~((size_t)SPL_CACHE_LINE - 1))
+
+/* Statistics counters updates, which vanish if they're not enabled. */
+#ifdef SPLAY_ENABLE_STATS
+#define SPL_STAT_ADD(tree, field, n) \
+    __atomic_fetch_add(&((tree)->_stats.field), (ulong)(n), __ATOMIC_RELAXED)
+#define SPL_STAT_MAX(tree, field, n) \
+    _spl_stat_max(&((tree)->_stats.field), (ulong)(n))
+#define SPL_STAT_DESCENT(tree, depth) \
+    (SPL_STAT_ADD(tree, descents, 1), \
+     SPL_STAT_ADD(tree, depth_total, depth), \
+     SPL_STAT_MAX(tree, depth_max, depth))
+#define SPL_STAT_SPLAY(tree, steps, rots) \
+    (SPL_STAT_ADD(tree, splays, 1), SPL_STAT_ADD(tree, splay_steps, steps), \
+     SPL_STAT_ADD(tree, rotations, rots))
+#else
+#define SPL_STAT_ADD(tree, field, n) ((void)(tree), (void)(n))
+#define SPL_STAT_MAX(tree, field, n) ((void)(tree), (void)(n))
+#define SPL_STAT_DESCENT(tree, depth) ((void)(tree), (void)(depth))
+#define SPL_STAT_SPLAY(tree, steps, rots) \
+    ((void)(tree), (void)(steps), (void)(rots))
+#endif
+
+#ifdef SPLAY_ENABLE_ORDER_STATS
+#define SPL_SIZE(node) (((node) != NULL) ? (node)->_size : 0)
+#define SPL_SIZE_FIX(node) \
+    ((node)->_size = SPL_SIZE((node)->_left_son) + \
+                     SPL_SIZE((node)->_right_son) + 1)
+#else
+#define SPL_SIZE_FIX(node) ((void)(node))
+#endif
+
+/* Internal library subroutines declarations. */
+SplayNode *_spl_create_node(SplayTree *tree, SPL_KEY new_key,
+                            void *new_data);
+void _spl_delete_node(SplayTree *tree, SplayNode *node);
+ulong _spl_free_nodes(SplayTree *tree, SplayNode *root, int opts,
+                      int release);
+SplayChunk *_spl_pool_add_chunk(SplayPool *pool, ulong capacity);
+SplayNode *_spl_pool_alloc(SplayPool *pool);
+void _spl_pool_free(SplayPool *pool, SplayNode *node);
+void _spl_pool_share(SplayPool *pool);
+void _spl_pool_absorb(SplayPool *dst, SplayPool *src);
+void _spl_pool_release(SplayPool *pool);
+int _spl_pool_is_shared(SplayPool *pool);
+SplayNode *_spl_build_balanced(SplayNode *nodes, SPL_KEY_ARG const *keys,
+                               void **data, ulong first, ulong last);
+SplayNode *_spl_search_node(SplayTree *tree, SPL_KEY key, ulong *depth);
+SplayNode *_spl_search_from(SplayTree *tree, SplayNode *start, SPL_KEY key,
+                            ulong *depth);
+SplayNode *_spl_finger_climb(SplayNode *finger, SPL_KEY key);
+void _spl_insert_root(SplayTree *tree, SplayNode *new_node,
+                      SplayNode *old_root);
+SplayNode *_spl_find_or_insert(SplayTree *tree, SPL_KEY key, void *data,
+                               int *inserted);
+int _spl_evict(SplayTree *tree, SPL_KEY key);
+ulong _spl_tree_to_vine(SplayNode *header);
+void _spl_vine_compress(SplayNode *header, ulong count);
+void _spl_vine_to_tree(SplayNode *header, ulong count);
+ulong _spl_floor_log2(ulong n);
+ulong *_spl_batch_order(SPL_KEY_ARG const *keys, ulong n);
+ulong _spl_batch_descend(SplayTree *tree, SPL_KEY_ARG const *keys,
+                         const ulong *order, ulong n, void **out, int opts);
+SplayNode *_spl_lower_bound(SplayNode *root, SPL_KEY key);
+SplayNode *_spl_floor_bound(SplayNode *root, SPL_KEY key);
+SplayNode *_spl_nearest(SplayTree *tree, SPL_KEY key, int greater, int strict,
+                        ulong *depth);
+void *_spl_nearest_result(SplayTree *tree, SplayNode *node, ulong depth,
+                          int opts);
+void _spl_splay_found(SplayTree *tree, SplayNode *node, ulong depth, int opts);
+void _spl_insert_left_subtree(SplayNode *father, SplayNode *new_son);
+void _spl_insert_right_subtree(SplayNode *father, SplayNode *new_son);
+SplayNode *_spl_cut_left_subtree(SplayNode *father);
+SplayNode *_spl_cut_right_subtree(SplayNode *father);
+SplayNode *_spl_max_key_son(SplayNode *node);
+SplayNode *_spl_min_key_son(SplayNode *node);
+SplayNode *_spl_successor(SplayNode *node);
+SplayNode *_spl_predecessor(SplayNode *node);
+void _spl_right_rotation(SplayNode *node);
+void _spl_left_rotation(SplayNode *node);
+SplayNode *_spl_splay(SplayNode *node);
+void _spl_splay_node(SplayTree *tree, SplayNode *node);
+void _spl_splay_subtree(SplayTree *tree, SplayNode *node);
+void _spl_semi_splay_node(SplayTree *tree, SplayNode *node);
+SplayNode *_spl_join(SplayTree *tree, SplayNode *left_root,
+                     SplayNode *right_root);
+SplayNode *_spl_td_splay(SplayTree *tree, SplayNode *root, SPL_KEY key);
+SplayNode *_spl_td_splay_max(SplayTree *tree, SplayNode *root);
+SplayNode *_spl_td_splay_min(SplayTree *tree, SplayNode *root);
+SplayNode *_spl_splay_max(SplayTree *tree);
+SplayNode *_spl_splay_min(SplayTree *tree);
+SplayNode *_spl_splay_floor(SplayTree *tree, SPL_KEY key);
+ulong _spl_count_left(SplayNode *left_root, SplayNode *right_root,
+                      ulong total);
+void _spl_sync_log_access(SplaySyncTree *stree, SPL_KEY key);
+void _spl_sync_log_destroy(void *log);
+void _spl_sync_apply_logs(SplaySyncTree *stree);
+SplayNode *_spl_td_join(SplayTree *tree, SplayNode *left_root,
+                        SplayNode *right_root);
+SplayNode *_spl_dfs_next(SplayNode *root_node, SplayNode **curr,
+                         SplayNode **prev, int order);
+void *_spl_store_node(void *dst, SplayNode *node, int int_opt);
+void *_spl_dfs_fill(SplayNode *root_node, int order, int int_opt,
+                    void *dst);
+int _spl_walk_opts(int opts);
+SplayNode *_spl_level_first(SplayNode *sub_root, ulong depth, int type);
+SplayNode *_spl_level_next(SplayNode *root_node, SplayNode *node, int type);
+unsigned int _spl_shard_index(SplayShardTree *shtree, SPL_KEY key);
+SplayNode *_spl_shard_iter_walk(SplayShardIter *iter,
+                                SplayNode *node);
+SplayNode *_spl_shard_iter_pick(SplayShardIter *iter);
+void _spl_stat_max(ulong *counter, ulong value);
+#ifdef SPLAY_ENABLE_ORDER_STATS
+void _spl_size_fix_path(SplayNode *node);
+void _spl_size_fix_all(SplayNode *root);
+#endif
+unsigned int _spl_compact_alloc(SplayCompactTree *ctree);
+int _spl_compact_grow(SplayCompactTree *ctree, ulong capacity);
+unsigned int _spl_compact_splay(SplayCompactNode *nodes, unsigned int root,
+                                SPL_KEY key);
+unsigned int _spl_compact_splay_max(SplayCompactNode *nodes,
+                                    unsigned int root);
+ulong _spl_frozen_bound(SplayFrozen *frozen, SPL_KEY key, int strict);
+ulong _spl_frozen_next(ulong n, ulong pos);
+ulong _spl_frozen_prev(ulong n, ulong pos);
+void _spl_stats_merge(SplayStats *dst, const SplayStats *src);
+void _spl_shape_memory(SplayTree *tree, SplayShape *shape);
+void _spl_shape_walk(SplayNode *root, SplayShape *shape);
+void _spl_shape_probe(SplayNode *root, SplayShape *shape, ulong samples);
+int _spl_write_all(int fd, const void *buf, size_t size);
+int _spl_read_all(int fd, void *buf, size_t size);
+#ifdef SPL_KEY_PLAIN
+unsigned int _spl_snapshot_link(SplayCompactNode *nodes, ulong first,
+                                ulong last);
+int _spl_snapshot_write(int fd, SplayCompactNode *nodes, void **data,
+                        ulong n);
+int _spl_snapshot_read(int fd, SplaySnapshot *header,
+                       SplayCompactNode **nodes, void ***data);
+#endif
+
+// USER FUNCTIONS //
+/**
+ * Creates a new Splay Tree in the heap.
+ *
+ * @return Pointer to the newly created tree, NULL if allocation failed.
+ */
+SplayTree *create_splay_tree(void) {
+    return create_splay_tree_ex(NULL);
+}
+
+/**
+ * Creates a new Splay Tree in the heap, which nodes will be allocated from a
+ * pool configured as specified (see header). No memory is reserved for nodes
+ * until the first insertion.
+ *
+ * @param pool_cfg Pointer to the pool configuration, NULL for no pool.
+ * @return Pointer to the newly created tree, NULL if allocation failed.
+ */
+SplayTree *create_splay_tree_ex(const SplayPoolConfig *pool_cfg) {
+    SplayTree *new_tree = (SplayTree *)malloc(sizeof(SplayTree));
+    if (new_tree == NULL) return NULL;
+    new_tree->_pool = NULL;
+    if (pool_cfg != NULL) {
+        SplayPool *new_pool = (SplayPool *)malloc(sizeof(SplayPool));
+        if (new_pool == NULL) {
+            free(new_tree);
+            return NULL;
+        }
+        new_pool->_chunks = NULL;
+        new_pool->_curr_chunk = NULL;
+        new_pool->_curr_used = 0;
+        new_pool->_free_list = NULL;
+        new_pool->_nodes_per_chunk = pool_cfg->nodes_per_chunk ?
+            pool_cfg->nodes_per_chunk : SPL_POOL_CHUNK_NODES;
+        new_pool->_refs = 1;
+        new_pool->_shared = 0;
+        pthread_mutex_init(&(new_pool->_lock), NULL);
+        new_tree->_pool = new_pool;
+    }
+    new_tree->_root = NULL;
+    new_tree->_finger = NULL;
+    new_tree->nodes_count = 0;
+    new_tree->max_nodes = ULONG_MAX;
+    new_tree->splay_opts = 0;
+    new_tree->splay_depth = 0;
+    new_tree->rebalance_factor = 2;
+    new_tree->evict_callback = NULL;
+    new_tree->evict_ctx = NULL;
+#ifdef SPLAY_ENABLE_STATS
+    new_tree->_stats = (SplayStats){0};
+#endif
+    return new_tree;
+}
+
+/**
+ * Frees a given Splay Tree from the heap. Using options defined in the 
+ * header, it's possible to specify whether also keys and data have to be
+ * freed or not.
+ *
+ * @param tree Pointer to the tree to free.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int delete_splay_tree(SplayTree *tree, int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (opts < 0)) return -1;
+    // If other trees are using the same pool, nodes must be given back to it.
+    int give_back = (tree->_pool != NULL) && _spl_pool_is_shared(tree->_pool);
+    // Nodes have to be visited only if they're not in a pool, or to free keys
+    // and data.
+    if ((tree->_pool == NULL) || give_back ||
+        (opts & (DELETE_FREE_KEYS | DELETE_FREE_DATA)))
+        _spl_free_nodes(tree, tree->_root, opts,
+                        (tree->_pool == NULL) || give_back);
+    // Pooled nodes are released chunk by chunk, with the last tree using them.
+    if (tree->_pool != NULL) _spl_pool_release(tree->_pool);
+    // Free the tree, and that's it!
+    free(tree);
+    return 0;
+}
+
+/**
+ * Deletes all entries from a tree, which stays ready for new insertions.
+ * Using options defined in the header, it's possible to specify whether also
+ * keys and data have to be freed or not. If the tree has a pool of its own,
+ * its chunks are kept and nodes will be carved out of them again; shared
+ * pools get the nodes back one by one instead.
+ *
+ * @param tree Pointer to the tree to clear.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int splay_clear(SplayTree *tree, int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (opts < 0)) return -1;
+    SplayPool *pool = tree->_pool;
+    int give_back = (pool != NULL) && _spl_pool_is_shared(pool);
+    if ((pool == NULL) || give_back ||
+        (opts & (DELETE_FREE_KEYS | DELETE_FREE_DATA)))
+        _spl_free_nodes(tree, tree->_root, opts,
+                        (pool == NULL) || give_back);
+    // An unshared pool can start over from its first chunk.
+    if ((pool != NULL) && !give_back) {
+        pool->_curr_chunk = pool->_chunks;
+        pool->_curr_used = 0;
+        pool->_free_list = NULL;
+    }
+    tree->_root = NULL;
+    tree->_finger = NULL;
+    tree->nodes_count = 0;
+    return 0;
+}
+
+/**
+ * Searches for an entry with the specified key in the tree.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in a node (if any) or pointer to the node (if any).
+ */
+void *splay_search(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayNode *searched_node;
+    int splay_mode = opts | tree->splay_opts;
+    if ((opts & SEARCH_SPLAY) &&
+        !(splay_mode & (SPLAY_BOTTOM_UP | SPLAY_SEMI | SPLAY_DEPTH_LIMIT))) {
+        // Find and splay the searched node with a single descent.
+        SPL_STAT_ADD(tree, searches, 1);
+        if (tree->_root != NULL)
+            tree->_root = _spl_td_splay(tree, tree->_root, key_val);
+        if ((tree->_root == NULL) ||
+            (SPL_KEY_CMP(tree->_root->_key, key_val) != 0)) {
+            SPL_STAT_ADD(tree, misses, 1);
+            return NULL;
+        }
+        searched_node = tree->_root;
+    } else {
+        ulong depth = 0;
+        SPL_STAT_ADD(tree, searches, 1);
+        searched_node = _spl_search_node(tree, key_val, &depth);
+        // Rebuild the tree if it's grown too deep (see header).
+        if ((opts & SEARCH_REBALANCE) && (tree->rebalance_factor > 0) &&
+            (tree->nodes_count >= 3) &&
+            (depth > tree->rebalance_factor *
+                     _spl_floor_log2(tree->nodes_count))) {
+            splay_rebalance(tree);
+            // The node has moved, so depth limits must see its new depth.
+            depth = 0;
+            if (searched_node != NULL)
+                for (SplayNode *curr = searched_node; curr->_father != NULL;
+                     curr = curr->_father) depth++;
+        }
+        if (searched_node == NULL) {
+            SPL_STAT_ADD(tree, misses, 1);
+            return NULL;
+        }
+        // Splay the searched node, if it's deep enough.
+        if ((opts & SEARCH_SPLAY) &&
+            (!(splay_mode & SPLAY_DEPTH_LIMIT) || (depth > tree->splay_depth))) {
+            if (splay_mode & SPLAY_SEMI)
+                _spl_semi_splay_node(tree, searched_node);
+            else _spl_splay_node(tree, searched_node);
+        }
+    }
+    SPL_STAT_ADD(tree, hits, 1);
+    if (opts & SEARCH_DATA) return searched_node->_data;
+    if (opts & SEARCH_NODES) return (void *)searched_node;
+    return NULL;
+}
+
+/**
+ * Searches for an entry with the specified key in the tree, starting from the
+ * node found by the previous finger search instead of the root: the search
+ * climbs from there only as far as needed, so that keys close to the last one
+ * found take time logarithmic in their distance from it. The node found
+ * becomes the new finger, so this must not run concurrently with other
+ * searches. If a splay is requested, it's always done bottom-up, whatever the
+ * tree's splaying mode, since a top-down one would descend from the root.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in a node (if any) or pointer to the node (if any).
+ */
+void *splay_finger_search(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayNode *start = tree->_root;
+    SplayNode *node = NULL;
+    ulong depth = 0;
+    if (tree->_finger != NULL) start = _spl_finger_climb(tree->_finger, key_val);
+    if (start != NULL) node = _spl_search_from(tree, start, key_val, NULL);
+    if ((node != NULL) && (opts & SEARCH_SPLAY) &&
+        ((opts | tree->splay_opts) & SPLAY_DEPTH_LIMIT)) {
+        // Depth limits apply to the depth from the root.
+        for (SplayNode *curr = node; curr->_father != NULL;
+             curr = curr->_father) depth++;
+    }
+    if (node != NULL) tree->_finger = node;
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the greatest key less than or equal to the given
+ * one (i.e. its floor).
+ *
+ * @param tree Tree to search into.
+ * @param key Key to start from.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_floor(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    ulong depth = 0;
+    SplayNode *node = _spl_nearest(tree, SPL_KEY_MAKE(key), 0, 0, &depth);
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the least key greater than or equal to the given
+ * one (i.e. its ceiling).
+ *
+ * @param tree Tree to search into.
+ * @param key Key to start from.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_ceiling(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    ulong depth = 0;
+    SplayNode *node = _spl_nearest(tree, SPL_KEY_MAKE(key), 1, 0, &depth);
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the greatest key less than the given one, which
+ * doesn't have to be in the tree.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to start from.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_predecessor(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    ulong depth = 0;
+    SplayNode *node = _spl_nearest(tree, SPL_KEY_MAKE(key), 0, 1, &depth);
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the least key greater than the given one, which
+ * doesn't have to be in the tree.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to start from.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_successor(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    ulong depth = 0;
+    SplayNode *node = _spl_nearest(tree, SPL_KEY_MAKE(key), 1, 1, &depth);
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the least key in the tree.
+ *
+ * @param tree Tree to search into.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_min(SplayTree *tree, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    SplayNode *node = tree->_root;
+    ulong depth = 0;
+    if (node != NULL) {
+        while (node->_left_son != NULL) {
+            node = node->_left_son;
+            depth++;
+        }
+        SPL_STAT_DESCENT(tree, depth);
+    }
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry with the greatest key in the tree.
+ *
+ * @param tree Tree to search into.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any).
+ */
+void *splay_max(SplayTree *tree, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+    SplayNode *node = tree->_root;
+    ulong depth = 0;
+    if (node != NULL) {
+        while (node->_right_son != NULL) {
+            node = node->_right_son;
+            depth++;
+        }
+        SPL_STAT_DESCENT(tree, depth);
+    }
+    return _spl_nearest_result(tree, node, depth, opts);
+}
+
+/**
+ * Looks for the entry at a given position in key order, starting from 0, in
+ * logarithmic amortized time if splaying. Requires subtree sizes (see
+ * header).
+ *
+ * @param tree Tree to search into.
+ * @param pos Position of the entry, i.e. number of entries that come before.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node found (if any) or pointer to the node (if
+ *         any), NULL if sizes are not kept.
+ */
+void *splay_select(SplayTree *tree, ulong pos, int opts) {
+    if ((opts <= 0) || (tree == NULL)) return NULL;  // Sanity check.
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    SplayNode *curr = NULL;
+    ulong depth = 0;
+    if (pos < tree->nodes_count) {
+        curr = tree->_root;
+        for (;;) {
+            ulong left_size = SPL_SIZE(curr->_left_son);
+            if (pos == left_size) break;
+            if (pos < left_size) {
+                curr = curr->_left_son;
+            } else {
+                pos -= left_size + 1;
+                curr = curr->_right_son;
+            }
+            depth++;
+        }
+        SPL_STAT_DESCENT(tree, depth);
+    }
+    return _spl_nearest_result(tree, curr, depth, opts);
+#else
+    (void)pos;
+    return NULL;
+#endif
+}
+
+/**
+ * Counts the entries with keys less than the given one, which doesn't have to
+ * be in the tree, in logarithmic amortized time if splaying. Requires subtree
+ * sizes (see header).
+ * If requested, the last node reached is splayed.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to look for.
+ * @param rank Pointer to the location to return the count into.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return 0 if all went well, -1 if sizes are not kept or input args were bad.
+ */
+int splay_rank(SplayTree *tree, SPL_KEY_ARG key, ulong *rank, int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (rank == NULL) || (opts < 0)) return -1;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayNode *curr = tree->_root;
+    SplayNode *last = NULL;
+    ulong depth = 0, count = 0;
+    while (curr != NULL) {
+        last = curr;
+        if (SPL_KEY_CMP(curr->_key, key_val) < 0) {
+            // This one and all its left subtree come first.
+            count += SPL_SIZE(curr->_left_son) + 1;
+            curr = curr->_right_son;
+        } else curr = curr->_left_son;
+        depth++;
+    }
+    if (last != NULL) {
+        SPL_STAT_DESCENT(tree, depth - 1);
+        _spl_splay_found(tree, last, depth - 1, opts);
+    }
+    *rank = count;
+    return 0;
+#else
+    (void)key;
+    return -1;
+#endif
+}
+
+/**
+ * Deletes an entry from the tree.
+ *
+ * @param tree Pointer to the tree to delete from.
+ * @param key Key to delete from the dictionary.
+ * @param opts Also willing to free the stored data?
+ * @return 1 if found and deleted, 0 if not found or input args were bad.
+ */
+int splay_delete(SplayTree *tree, SPL_KEY_ARG key, int opts) {
+    // Sanity check on input arguments.
+    if ((opts < 0) || (tree == NULL)) return 0;
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayNode *to_delete;
+    if (tree->splay_opts & SPLAY_BOTTOM_UP) {
+        to_delete = _spl_search_node(tree, key_val, NULL);
+        // Splay the target node.
+        if (to_delete != NULL) _spl_splay_node(tree, to_delete);
+    } else {
+        // Find and splay the target node with a single descent.
+        if (tree->_root == NULL) return 0;
+        tree->_root = _spl_td_splay(tree, tree->_root, key_val);
+        to_delete = (SPL_KEY_CMP(tree->_root->_key, key_val) == 0) ?
+                    tree->_root : NULL;
+    }
+    if (to_delete != NULL) {
+        // Remove the new root from the tree, then join the two subtrees.
+        SplayNode *left_sub = _spl_cut_left_subtree(to_delete);
+        SplayNode *right_sub = _spl_cut_right_subtree(to_delete);
+        if (tree->splay_opts & SPLAY_BOTTOM_UP)
+            tree->_root = _spl_join(tree, left_sub, right_sub);
+        else tree->_root = _spl_td_join(tree, left_sub, right_sub);
+        // Apply eventual options to free keys and data, then free the node.
+        if (opts & DELETE_FREE_KEYS) SPL_KEY_FREE(to_delete->_key);
+        if (opts & DELETE_FREE_DATA) free(to_delete->_data);
+        if (tree->_finger == to_delete) tree->_finger = NULL;
+        _spl_delete_node(tree, to_delete);
+        tree->nodes_count--;
+        return 1;  // Found and deleted.
+    }
+    return 0;  // Not found.
+}
+
+/**
+ * Deletes all entries with keys in the closed interval [lo, hi] from the tree.
+ * The entries that precede and follow the range are splayed, the latter to the
+ * root and the former right below it, so that the range is left as a subtree
+ * of its own, which is then cut off and freed in a single pass. This takes
+ * logarithmic amortized time plus the number of entries deleted.
+ * Since both entries have to be found before they're moved, they're always
+ * splayed bottom-up, whatever the tree's splaying mode.
+ *
+ * @param tree Pointer to the tree to delete from.
+ * @param lo Least key in the range.
+ * @param hi Greatest key in the range.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return Number of entries deleted, 0 if none or input args were bad.
+ */
+ulong splay_delete_range(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                         int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (tree->_root == NULL) || (opts < 0)) return 0;
+    SPL_KEY lo_val = SPL_KEY_MAKE(lo), hi_val = SPL_KEY_MAKE(hi);
+    if (SPL_KEY_CMP(lo_val, hi_val) > 0) return 0;
+    // Look for the last entry before the range and the first one after it.
+    ulong depth = 0;
+    SplayNode *pred = _spl_nearest(tree, lo_val, 0, 1, &depth);
+    SplayNode *succ = _spl_nearest(tree, hi_val, 1, 1, &depth);
+    SplayNode *range;
+    if (succ != NULL) {
+        // Splay the predecessor in the left subtree of the successor.
+        _spl_splay_node(tree, succ);
+        range = _spl_cut_left_subtree(succ);
+        if (pred != NULL) {
+            _spl_splay_subtree(tree, pred);
+            range = _spl_cut_right_subtree(pred);
+            SPL_SIZE_FIX(pred);
+            _spl_insert_left_subtree(succ, pred);
+        }
+        SPL_SIZE_FIX(succ);
+    } else if (pred != NULL) {
+        _spl_splay_node(tree, pred);
+        range = _spl_cut_right_subtree(pred);
+        SPL_SIZE_FIX(pred);
+    } else {
+        // The range holds the whole tree.
+        range = tree->_root;
+        tree->_root = NULL;
+    }
+    if ((tree->_finger != NULL) &&
+        (SPL_KEY_CMP(tree->_finger->_key, lo_val) >= 0) &&
+        (SPL_KEY_CMP(tree->_finger->_key, hi_val) <= 0)) tree->_finger = NULL;
+    ulong count = _spl_free_nodes(tree, range, opts, 1);
+    tree->nodes_count -= count;
+    return count;
+}
+
+/**
+ * Creates and inserts a new node in the tree.
+ * If the tree is full and SPLAY_EVICT is set in its options, an entry is
+ * evicted first (see header).
+ *
+ * @param tree Pointer to the tree to insert into.
+ * @param new_key New key to add to the dictionary.
+ * @param new_data New data to store into the dictionary.
+ * @return Internal nodes counter after the insertion, or 0 if full/bad args.
+ */
+ulong splay_insert(SplayTree *tree, SPL_KEY_ARG new_key, void *new_data) {
+    if (tree == NULL) return 0;  // Sanity check.
+    if ((tree->nodes_count == tree->max_nodes) &&
+        !_spl_evict(tree, SPL_KEY_MAKE(new_key))) return 0;  // Full.
+    SplayNode *new_node = _spl_create_node(tree, SPL_KEY_MAKE(new_key),
+                                          new_data);
+    if (new_node == NULL) return 0;  // Allocation failed.
+    if (tree->_root == NULL) {
+        // The tree is empty.
+        tree->_root = new_node;
+        tree->nodes_count++;
+    } else if (!(tree->splay_opts & SPLAY_BOTTOM_UP)) {
+        // Splay the closest key to the root, then place the new node above it.
+        _spl_insert_root(tree, new_node,
+                         _spl_td_splay(tree, tree->_root, new_node->_key));
+        tree->nodes_count++;
+    } else {
+        // Look for the correct position and place it there.
+        SplayNode *curr = tree->_root;
+        SplayNode *pred = NULL;
+        ulong depth = 0;
+        int comp;
+        while (curr != NULL) {
+            pred = curr;
+            comp = SPL_KEY_CMP(curr->_key, new_node->_key);
+            // Equals are kept in the left subtree.
+            if (comp >= 0) curr = curr->_left_son;
+            else curr = curr->_right_son;
+            depth++;
+        }
+        SPL_STAT_DESCENT(tree, depth - 1);
+        comp = SPL_KEY_CMP(pred->_key, new_node->_key);
+        if (comp >= 0) _spl_insert_left_subtree(pred, new_node);
+        else _spl_insert_right_subtree(pred, new_node);
+        // Splay the new node.
+        _spl_splay_node(tree, new_node);
+        tree->nodes_count++;
+    }
+    return tree->nodes_count;  // Return the result of the insertion.
+}
+
+/**
+ * Stores an entry in the tree, replacing the data of the entry with the same
+ * key if there's one, with a single descent and a single splay. Keys stay
+ * unique as long as they're only added like this.
+ * If the key is already there, the stored one is kept and the given one is
+ * not stored.
+ *
+ * @param tree Pointer to the tree to store into.
+ * @param key Key of the entry.
+ * @param data New data to store.
+ * @param old_data Pointer to the location to return the replaced data into,
+ *        NULL if the entry is new; can be NULL.
+ * @return 1 if the entry was inserted, 0 if it was updated, -1 if the tree is
+ *         full, allocation failed or input args were bad.
+ */
+int splay_upsert(SplayTree *tree, SPL_KEY_ARG key, void *data,
+                 void **old_data) {
+    if (tree == NULL) return -1;  // Sanity check.
+    int inserted;
+    SplayNode *node = _spl_find_or_insert(tree, SPL_KEY_MAKE(key), data,
+                                          &inserted);
+    if (node == NULL) return -1;
+    if (old_data != NULL) *old_data = inserted ? NULL : node->_data;
+    node->_data = data;
+    return inserted;
+}
+
+/**
+ * Returns the entry with the given key, inserting it with the given data if
+ * there's none, with a single descent and a single splay. Either way, the
+ * entry's node becomes the root.
+ * If the key is already there, the stored one is kept and the given one is
+ * not stored.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param key Key of the entry.
+ * @param data Data to store if the entry is new.
+ * @param inserted Pointer to the location to return whether the entry is new
+ *        into; can be NULL.
+ * @return Pointer to the entry's node, NULL if the tree is full, allocation
+ *         failed or input args were bad.
+ */
+SplayNode *splay_get_or_insert(SplayTree *tree, SPL_KEY_ARG key, void *data,
+                               int *inserted) {
+    if (tree == NULL) return NULL;  // Sanity check.
+    int is_new;
+    SplayNode *node = _spl_find_or_insert(tree, SPL_KEY_MAKE(key), data,
+                                          &is_new);
+    if ((node != NULL) && (inserted != NULL)) *inserted = is_new;
+    return node;
+}
+
+/**
+ * Searches for many keys at once, in increasing order, storing in an array
+ * what each search returns. With SEARCH_SPLAY, each key is splayed in turn,
+ * so that it's found close to the root where the previous one was left;
+ * otherwise, groups of searches descend the tree together, so that their
+ * cache misses overlap, and the tree is not modified.
+ * If sorting the keys fails, they're searched in the order given.
+ *
+ * @param tree Tree to search into.
+ * @param keys Pointer to the keys to look for.
+ * @param n Number of keys.
+ * @param out Pointer to an array of n results, each one in the position of
+ *        its key.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Number of keys found, 0 if input args were bad.
+ */
+ulong splay_search_batch(SplayTree *tree, SPL_KEY_ARG const *keys, ulong n,
+                         void **out, int opts) {
+    // Sanity check on input arguments.
+    if ((opts <= 0) || (tree == NULL) || (keys == NULL) || (out == NULL))
+        return 0;
+    ulong *order = _spl_batch_order(keys, n);
+    ulong found = 0;
+    if (opts & SEARCH_SPLAY) {
+        // Nodes are asked for, to tell misses from NULL data.
+        int node_opts = (opts & ~SEARCH_DATA) | SEARCH_NODES;
+        for (ulong i = 0; i < n; i++) {
+            ulong pos = (order != NULL) ? order[i] : i;
+            SplayNode *node = splay_search(tree, keys[pos], node_opts);
+            out[pos] = NULL;
+            if (node != NULL) {
+                found++;
+                if (opts & SEARCH_DATA) out[pos] = node->_data;
+                else if (opts & SEARCH_NODES) out[pos] = (void *)node;
+            }
+        }
+    } else found = _spl_batch_descend(tree, keys, order, n, out, opts);
+    free(order);
+    return found;
+}
+
+/**
+ * Inserts many entries at once, in increasing order of their keys, so that
+ * each insertion only has to splay the previous one, close to the root.
+ * Stops at the first insertion that fails.
+ *
+ * @param tree Pointer to the tree to insert into.
+ * @param keys Pointer to the new keys.
+ * @param data Pointer to the new data, each one in the position of its key,
+ *        or NULL to store NULL everywhere.
+ * @param n Number of entries.
+ * @return Number of entries inserted, 0 if input args were bad.
+ */
+ulong splay_insert_batch(SplayTree *tree, SPL_KEY_ARG const *keys,
+                         void **data, ulong n) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (keys == NULL)) return 0;
+    ulong *order = _spl_batch_order(keys, n);
+    ulong inserted = 0;
+    for (ulong i = 0; i < n; i++) {
+        ulong pos = (order != NULL) ? order[i] : i;
+        if (splay_insert(tree, keys[pos],
+                         (data != NULL) ? data[pos] : NULL) == 0) break;
+        inserted++;
+    }
+    free(order);
+    return inserted;
+}
+
+/**
+ * Performs a depth-first search of the tree, the type of which can be 
+ * specified using the options defined in the header. 
+ * Depending on the option specified, returns an array of: 
+ * - Pointers to the nodes. 
+ * - Keys. 
+ * - Data. 
+ * See the header for the definitions of such options. 
+ * Remember to free the returned array afterwards!
+ *
+ * @param tree Pointer to the tree to operate on.
+ * @param type Type of DFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_dfs(SplayTree *tree, int type, int opts) {
+    // Sanity check for the input arguments.
+    if ((type <= 0) || (opts <= 0)) return NULL;
+    if ((tree == NULL) || (tree->_root == NULL)) return NULL;
+    // Allocate memory according to options.
+    void **dfs_res;
+    int int_opt;
+    if (opts & SEARCH_DATA) {
+        int_opt = SEARCH_DATA;
+        dfs_res = calloc(tree->nodes_count, sizeof(void *));
+    } else if (opts & SEARCH_KEYS) {
+        int_opt = SEARCH_KEYS;
+        dfs_res = calloc(tree->nodes_count, sizeof(SPL_KEY_ARG));
+    } else if (opts & SEARCH_NODES) {
+        int_opt = SEARCH_NODES;
+        dfs_res = calloc(tree->nodes_count, sizeof(SplayNode *));
+    } else return NULL;  // Invalid option.
+    if (dfs_res == NULL) return NULL;  // calloc failed.
+    // Get the requested DFS order according to type.
+    int order;
+    if (type & DFS_PRE_ORDER) {
+        order = DFS_PRE_ORDER;
+    } else if (type & DFS_IN_ORDER) {
+        order = DFS_IN_ORDER;
+    } else if (type & DFS_POST_ORDER) {
+        order = DFS_POST_ORDER;
+    } else {
+        // Invalid type.
+        free(dfs_res);
+        return NULL;
+    }
+    // Walk the tree, storing what's requested of each node as it's visited.
+    _spl_dfs_fill(tree->_root, order, int_opt, (void *)dfs_res);
+    // The array is now filled with the requested data.
+    return dfs_res;
+}
+
+/**
+ * Performs a breadth-first search of the tree, the type of which can be 
+ * specified using the options defined in the header (left or right son 
+ * visited first). 
+ * Depending on the option specified, returns an array of: 
+ * - Pointers to the nodes. 
+ * - Keys. 
+ * - Data. 
+ * See the header for the definitions of such options. 
+ * Remember to free the returned array afterwards!
+ * 
+ * @param tree Pointer to the tree to operate on.
+ * @param type Type of BFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_bfs(SplayTree *tree, int type, int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (tree->_root == NULL) ||
+        (type <= 0) || (opts <= 0) ||
+        !((type & BFS_LEFT_FIRST) || (type & BFS_RIGHT_FIRST)) ||
+        !((opts & SEARCH_KEYS) || (opts & SEARCH_DATA) ||
+        (opts & SEARCH_NODES))) return NULL;
+    // Allocate memory in the heap.
+    void **bfs_res = NULL;
+    void **int_ptr;
+    // Used only if keys are searched, which are never wider than pointers.
+    SPL_KEY_ARG *key_ptr;
+    if (opts & SEARCH_DATA) {
+        bfs_res = calloc(tree->nodes_count, sizeof(void *));
+    } else if (opts & SEARCH_KEYS) {
+        bfs_res = calloc(tree->nodes_count, sizeof(SplayNode *));
+        key_ptr = (SPL_KEY_ARG *)bfs_res;
+    } else if (opts & SEARCH_NODES) {
+        bfs_res = calloc(tree->nodes_count, sizeof(SplayNode *));
+    } else return NULL;  // Invalid option.
+    if (bfs_res == NULL) return NULL;  // Calloc failed.
+    int_ptr = bfs_res + 1;
+    *bfs_res = (void *)(tree->_root);
+    SplayNode *curr;
+    // Start the visit, using the same array to return as a temporary queue
+    // for the nodes.
+    for (unsigned long int i = 0; i < tree->nodes_count; i++) {
+        curr = (SplayNode *)bfs_res[i];
+        // Visit the current node.
+        if (opts & SEARCH_DATA) {
+            bfs_res[i] = curr->_data;
+        } else if (opts & SEARCH_KEYS) {
+            *key_ptr = SPL_KEY_GET(curr->_key);
+            key_ptr++;
+        } else if (opts & SEARCH_NODES) {
+            bfs_res[i] = curr;
+        }
+        // Eventually add the sons to the array, to be visited afterwards.
+        if (type & BFS_LEFT_FIRST) {
+            if (curr->_left_son != NULL) {
+                *int_ptr = (void *)(curr->_left_son);
+                int_ptr++;
+            }
+            if (curr->_right_son != NULL) {
+                *int_ptr = (void *)(curr->_right_son);
+                int_ptr++;
+            }
+        } else if (type & BFS_RIGHT_FIRST) {
+            if (curr->_right_son != NULL) {
+                *int_ptr = (void *)(curr->_right_son);
+                int_ptr++;
+            }
+            if (curr->_left_son != NULL) {
+                *int_ptr = (void *)(curr->_left_son);
+                int_ptr++;
+            }
+        }
+    }
+    if ((opts & SEARCH_KEYS) && (sizeof(SPL_KEY_ARG) < sizeof(void *))) {
+        // If keys were searched, part of the array (half of it for int keys
+        // on x86_64) is totally unneeded, so we can release it.
+        // reallocarray is used instead of realloc to account for possible size
+        // computation overflows (see man).
+        if ((bfs_res = reallocarray(bfs_res, (size_t)(tree->nodes_count),
+                sizeof(SPL_KEY_ARG))) == NULL) {
+            free(bfs_res);
+            return NULL;
+        }
+    }
+    return bfs_res;
+}
+
+/**
+ * Performs a depth-first search of the tree like splay_dfs, but stores at most
+ * a given number of entries in a buffer provided by the caller, doing no
+ * allocation. The walk token keeps track of where the search got to, so that
+ * the next call with it goes on from there: calling this until it returns 0
+ * exports the whole tree one chunk at a time, always in the same buffer.
+ * The token must be zeroed before the first call, and type and options must
+ * be the same in all calls. The tree must not be modified in between, so
+ * splaying searches are not allowed either.
+ * The buffer must hold capacity entries of the requested kind (i.e. keys,
+ * data or pointers to the nodes).
+ *
+ * @param tree Pointer to the tree to operate on.
+ * @param type Type of DFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @param buf Pointer to the buffer to fill.
+ * @param capacity Number of entries the buffer can hold.
+ * @param walk Pointer to the walk token.
+ * @return Number of entries stored, 0 once the walk is over or if input
+ *         arguments were bad.
+ */
+ulong splay_dfs_buf(SplayTree *tree, int type, int opts, void *buf,
+                    ulong capacity, SplayWalk *walk) {
+    // Sanity check for the input arguments.
+    if ((tree == NULL) || (buf == NULL) || (walk == NULL) ||
+        (type <= 0) || (capacity == 0)) return 0;
+    int int_opt = _spl_walk_opts(opts);
+    if (int_opt == 0) return 0;
+    // Get the requested DFS order according to type.
+    int order;
+    if (type & DFS_PRE_ORDER) {
+        order = DFS_PRE_ORDER;
+    } else if (type & DFS_IN_ORDER) {
+        order = DFS_IN_ORDER;
+    } else if (type & DFS_POST_ORDER) {
+        order = DFS_POST_ORDER;
+    } else return 0;  // Invalid type.
+    if (walk->_state == 0) {
+        // Start a new walk from the root.
+        walk->_curr = tree->_root;
+        walk->_prev = (tree->_root != NULL) ? tree->_root->_father : NULL;
+        walk->_state = 1;
+    }
+    // Go on with the walk until the buffer is full or the tree is over.
+    void *dst = buf;
+    ulong stored = 0;
+    SplayNode *node;
+    while ((stored < capacity) &&
+           ((node = _spl_dfs_next(tree->_root, &(walk->_curr),
+                                  &(walk->_prev), order)) != NULL)) {
+        dst = _spl_store_node(dst, node, int_opt);
+        stored++;
+    }
+    if (walk->_curr == NULL) walk->_state = 2;
+    return stored;
+}
+
+/**
+ * Performs a breadth-first search of the tree like splay_bfs, but stores at
+ * most a given number of entries in a buffer provided by the caller, doing no
+ * allocation and using walk tokens as splay_dfs_buf does (see there).
+ * Since there's no queue to keep, each level is walked by climbing back from
+ * the last node visited on it to the next one, while the sons met on the way
+ * tell where the next level begins and ends. Walks down a single chain, like
+ * those left by insertions of sequential keys, thus take linear time, but in
+ * the worst case (e.g. two long chains hanging from the root) a whole search
+ * takes time proportional to the size of the tree times its height, that is,
+ * quadratic in its size: use splay_bfs instead if memory can be allocated.
+ *
+ * @param tree Pointer to the tree to operate on.
+ * @param type Type of BFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @param buf Pointer to the buffer to fill.
+ * @param capacity Number of entries the buffer can hold.
+ * @param walk Pointer to the walk token.
+ * @return Number of entries stored, 0 once the walk is over or if input
+ *         arguments were bad.
+ */
+ulong splay_bfs_buf(SplayTree *tree, int type, int opts, void *buf,
+                    ulong capacity, SplayWalk *walk) {
+    // Sanity check for the input arguments.
+    if ((tree == NULL) || (buf == NULL) || (walk == NULL) ||
+        (type <= 0) || (capacity == 0) ||
+        !((type & BFS_LEFT_FIRST) || (type & BFS_RIGHT_FIRST))) return 0;
+    int int_opt = _spl_walk_opts(opts);
+    if (int_opt == 0) return 0;
+    int lr_type = (type & BFS_LEFT_FIRST) ? BFS_LEFT_FIRST : BFS_RIGHT_FIRST;
+    if (walk->_state == 0) {
+        // Start a new walk from the root.
+        walk->_curr = tree->_root;
+        walk->_level_last = tree->_root;
+        walk->_next_first = NULL;
+        walk->_next_last = NULL;
+        walk->_depth = 0;
+        walk->_state = 1;
+    }
+    // Go on with the walk until the buffer is full or the tree is over.
+    void *dst = buf;
+    ulong stored = 0;
+    SplayNode *first, *second;
+    while ((stored < capacity) && (walk->_curr != NULL)) {
+        dst = _spl_store_node(dst, walk->_curr, int_opt);
+        stored++;
+        // Sons are met in BFS order, so they bound the next level.
+        first = (lr_type == BFS_LEFT_FIRST) ? walk->_curr->_left_son :
+                                              walk->_curr->_right_son;
+        second = (lr_type == BFS_LEFT_FIRST) ? walk->_curr->_right_son :
+                                               walk->_curr->_left_son;
+        if (first == NULL) first = second;
+        if (second == NULL) second = first;
+        if ((first != NULL) && (walk->_next_first == NULL))
+            walk->_next_first = first;
+        if (second != NULL) walk->_next_last = second;
+        // Move to the next node on the same level, or to the next level.
+        if (walk->_curr == walk->_level_last) {
+            walk->_curr = walk->_next_first;
+            walk->_level_last = walk->_next_last;
+            walk->_next_first = NULL;
+            walk->_next_last = NULL;
+            walk->_depth++;
+        } else walk->_curr = _spl_level_next(tree->_root, walk->_curr,
+                                             lr_type);
+    }
+    if (walk->_curr == NULL) walk->_state = 2;
+    return stored;
+}
+
+/**
+ * Builds a perfectly balanced Splay Tree from arrays of keys and data, in
+ * linear time. Keys must be sorted in non-decreasing order.
+ * All nodes are allocated at once, in a single chunk of the new tree's pool,
+ * and laid out in key order.
+ *
+ * @param keys Pointer to the array of keys.
+ * @param data Pointer to the array of data, or NULL to store only keys.
+ * @param n Number of entries in the arrays.
+ * @return Pointer to the new tree, NULL if allocation failed or bad args.
+ */
+SplayTree *splay_build_sorted(SPL_KEY_ARG const *keys, void **data,
+                             ulong n) {
+    // Sanity check on input arguments.
+    if ((keys == NULL) && (n > 0)) return NULL;
+    for (ulong i = 1; i < n; i++)
+        if (SPL_KEY_CMP(SPL_KEY_MAKE(keys[i - 1]), SPL_KEY_MAKE(keys[i])) > 0)
+            return NULL;
+    SplayPoolConfig pool_cfg = {0};
+    SplayTree *new_tree = create_splay_tree_ex(&pool_cfg);
+    if ((new_tree == NULL) || (n == 0)) return new_tree;
+    // Reserve all the nodes in a single chunk, then link them.
+    SplayChunk *chunk = _spl_pool_add_chunk(new_tree->_pool, n);
+    if (chunk == NULL) {
+        delete_splay_tree(new_tree, 0);
+        return NULL;
+    }
+    new_tree->_pool->_curr_used = n;
+    new_tree->_root =
+        _spl_build_balanced(SPL_CHUNK_NODES(chunk), keys, data, 0, n - 1);
+    new_tree->_root->_father = NULL;
+    new_tree->nodes_count = n;
+    return new_tree;
+}
+
+/**
+ * Initializes an iterator on a tree and returns the first node it visits.
+ * Nodes are visited by increasing keys, or by decreasing keys if ITER_REVERSE
+ * is specified. Each step takes constant amortized time.
+ * Typical usage is:
+ *   for (node = splay_iter_begin(tree, &iter, 0); node != NULL;
+ *        node = splay_iter_next(&iter)) { ... }
+ *   splay_iter_end(&iter);
+ *
+ * @param tree Pointer to the tree to walk.
+ * @param iter Pointer to the iterator to initialize.
+ * @param opts Iteration options (see header).
+ * @return Pointer to the first node, or NULL if none or input args were bad.
+ */
+SplayNode *splay_iter_begin(SplayTree *tree, SplayIter *iter,
+                            int opts) {
+    if (iter == NULL) return NULL;  // Sanity check.
+    iter->_curr = NULL;
+    iter->_opts = opts;
+    if ((tree == NULL) || (tree->_root == NULL) || (opts < 0)) return NULL;
+    if (opts & ITER_REVERSE) iter->_curr = _spl_max_key_son(tree->_root);
+    else iter->_curr = _spl_min_key_son(tree->_root);
+    return iter->_curr;
+}
+
+/**
+ * Moves an iterator to the next node in its order, and returns it.
+ *
+ * @param iter Pointer to the iterator to advance.
+ * @return Pointer to the next node, or NULL if the walk is over.
+ */
+SplayNode *splay_iter_next(SplayIter *iter) {
+    if ((iter == NULL) || (iter->_curr == NULL)) return NULL;
+    if (iter->_opts & ITER_REVERSE)
+        iter->_curr = _spl_predecessor(iter->_curr);
+    else iter->_curr = _spl_successor(iter->_curr);
+    return iter->_curr;
+}
+
+/**
+ * Terminates a walk. Since iterators hold no resources, this only makes the
+ * iterator return no more nodes.
+ *
+ * @param iter Pointer to the iterator to terminate.
+ */
+void splay_iter_end(SplayIter *iter) {
+    if (iter != NULL) iter->_curr = NULL;
+}
+
+/**
+ * Visits, in key order, all entries with keys in the closed interval [lo, hi]
+ * calling a callback on each one.
+ * If SEARCH_SPLAY is specified, the two boundaries of the range are splayed,
+ * so that the range costs logarithmic amortized time plus the number of
+ * entries in it. Otherwise the tree is not modified and this can run
+ * concurrently with other non-splaying operations.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param lo Least key in the range.
+ * @param hi Greatest key in the range.
+ * @param callback Function to call on each entry (see header), can be NULL.
+ * @param ctx Context pointer to pass to the callback.
+ * @param opts Configures the behaviour of the operation (see header).
+ * @return Number of entries visited, 0 if none or input args were bad.
+ */
+ulong splay_range(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                  SplayCallback callback, void *ctx, int opts) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (tree->_root == NULL) || (opts < 0)) return 0;
+    SPL_KEY lo_val = SPL_KEY_MAKE(lo), hi_val = SPL_KEY_MAKE(hi);
+    if (SPL_KEY_CMP(lo_val, hi_val) > 0) return 0;
+    // Look for the first node in the range.
+    SplayNode *first, *pred;
+    if ((opts & SEARCH_SPLAY) && !(tree->splay_opts & SPLAY_BOTTOM_UP)) {
+        // The new root is either the closest key to lo or an equal one, but
+        // more equal ones could precede it.
+        tree->_root = _spl_td_splay(tree, tree->_root, lo_val);
+        first = tree->_root;
+        if (SPL_KEY_CMP(first->_key, lo_val) < 0)
+            first = _spl_successor(first);
+        else while (((pred = _spl_predecessor(first)) != NULL) &&
+                    (SPL_KEY_CMP(pred->_key, lo_val) >= 0)) first = pred;
+    } else {
+        first = _spl_lower_bound(tree->_root, lo_val);
+        if ((opts & SEARCH_SPLAY) && (first != NULL))
+            _spl_splay_node(tree, first);
+    }
+    // Walk the range up to its end.
+    SplayNode *curr = first;
+    SplayNode *last = NULL;
+    ulong count = 0;
+    while ((curr != NULL) && (SPL_KEY_CMP(curr->_key, hi_val) <= 0)) {
+        count++;
+        last = curr;
+        if ((callback != NULL) &&
+            callback(SPL_KEY_GET(curr->_key), curr->_data, ctx)) break;
+        curr = _spl_successor(curr);
+    }
+    // Splay the other boundary.
+    if ((opts & SEARCH_SPLAY) && (last != NULL)) _spl_splay_node(tree, last);
+    return count;
+}
+
+/**
+ * Counts the entries with keys in the closed interval [lo, hi]. See
+ * splay_range for a description of the effects of SEARCH_SPLAY.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param lo Least key in the range.
+ * @param hi Greatest key in the range.
+ * @param opts Configures the behaviour of the operation (see header).
+ * @return Number of entries in the range, 0 if none or input args were bad.
+ */
+ulong splay_range_count(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                        int opts) {
+    return splay_range(tree, lo, hi, NULL, NULL, opts);
+}
+
+/**
+ * Splits a tree in two: the left one holds all entries with keys less than or
+ * equal to the given one, the right one all the others. The original tree is
+ * consumed and freed, while the new ones inherit its settings and its node
+ * pool, if any (see header).
+ * Takes logarithmic amortized time to split, plus time linear in the size of
+ * the smallest of the two new trees to count their nodes, unless subtree
+ * sizes are kept (see header).
+ *
+ * @param tree Pointer to the tree to split.
+ * @param key Key to split the tree at.
+ * @param left Pointer to the location to return the left tree into.
+ * @param right Pointer to the location to return the right tree into.
+ * @return 0 if all went well, -1 if allocation failed or input args were bad.
+ */
+int splay_split(SplayTree *tree, SPL_KEY_ARG key,
+                SplayTree **left, SplayTree **right) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (left == NULL) || (right == NULL)) return -1;
+    SplayTree *new_left = (SplayTree *)malloc(sizeof(SplayTree));
+    SplayTree *new_right = (SplayTree *)malloc(sizeof(SplayTree));
+    if ((new_left == NULL) || (new_right == NULL)) {
+        free(new_left);
+        free(new_right);
+        return -1;
+    }
+    *new_left = *tree;
+    *new_right = *tree;
+    new_left->_finger = NULL;
+    new_right->_finger = NULL;
+#ifdef SPLAY_ENABLE_STATS
+    // Counters stay with the left tree.
+    new_right->_stats = (SplayStats){0};
+#endif
+    // The original tree's reference to the pool goes to the left one.
+    if (tree->_pool != NULL) _spl_pool_share(tree->_pool);
+    SplayNode *floor = NULL;
+    if (tree->_root != NULL) floor = _spl_splay_floor(tree, SPL_KEY_MAKE(key));
+    if (floor == NULL) {
+        // All keys are greater than the given one.
+        new_left->_root = NULL;
+        new_left->nodes_count = 0;
+        new_right->_root = tree->_root;
+    } else {
+        // The right subtree of the new root holds all the greater keys.
+        new_left->_root = floor;
+        new_right->_root = _spl_cut_right_subtree(floor);
+#ifdef SPLAY_ENABLE_ORDER_STATS
+        SPL_SIZE_FIX(floor);
+        new_left->nodes_count = floor->_size;
+#else
+        new_left->nodes_count = _spl_count_left(new_left->_root,
+                                                new_right->_root,
+                                                tree->nodes_count);
+#endif
+        new_right->nodes_count = tree->nodes_count - new_left->nodes_count;
+    }
+    free(tree);
+    *left = new_left;
+    *right = new_right;
+    return 0;
+}
+
+/**
+ * Joins two trees, the keys in the first of which must all be less than or
+ * equal to the keys in the second one, in logarithmic amortized time.
+ * The left tree becomes the joined one and keeps its settings, while the right
+ * one is consumed and freed.
+ * Either both trees or none of them must have a node pool: if they don't share
+ * the same one, the right tree's pool must not be shared with others, and is
+ * merged into the left one.
+ *
+ * @param left Pointer to the left tree.
+ * @param right Pointer to the right tree.
+ * @return Pointer to the joined tree, NULL if the trees can't be joined.
+ */
+SplayTree *splay_join(SplayTree *left, SplayTree *right) {
+    // Sanity check on input arguments.
+    if ((left == NULL) || (right == NULL) || (left == right)) return NULL;
+    if ((left->_pool == NULL) != (right->_pool == NULL)) return NULL;
+    if ((left->_pool != right->_pool) && _spl_pool_is_shared(right->_pool))
+        return NULL;
+    if (right->nodes_count > left->max_nodes - left->nodes_count) return NULL;
+    // Splay the two closest keys to make sure that the trees are ordered.
+    if ((left->_root != NULL) && (right->_root != NULL)) {
+        if (SPL_KEY_CMP(_spl_splay_max(left)->_key,
+                        _spl_splay_min(right)->_key) > 0) return NULL;
+        _spl_insert_right_subtree(left->_root, right->_root);
+        SPL_SIZE_FIX(left->_root);
+    } else if (left->_root == NULL) left->_root = right->_root;
+    left->nodes_count += right->nodes_count;
+    // Take care of the right tree's nodes pool.
+    if (right->_pool != NULL) {
+        if (right->_pool == left->_pool) _spl_pool_release(right->_pool);
+        else _spl_pool_absorb(left->_pool, right->_pool);
+    }
+    free(right);
+    return left;
+}
+
+/**
+ * Rebuilds a tree into a perfectly balanced one, in which all levels are full
+ * but the last, using the Day-Stout-Warren algorithm: the tree is first
+ * turned into a vine (i.e. a chain of right sons) and then compressed with
+ * left rotations, level by level. This takes linear time and no memory, and
+ * keeps all nodes where they are in memory, so pointers to them stay valid.
+ *
+ * @param tree Pointer to the tree to rebalance.
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int splay_rebalance(SplayTree *tree) {
+    if (tree == NULL) return -1;  // Sanity check.
+    if (tree->nodes_count < 3) return 0;  // Nothing to do.
+    // The vine hangs from a dummy node, so that the root can be rotated too.
+    SplayNode header = {0};
+    header._right_son = tree->_root;
+    tree->_root->_father = &header;
+    _spl_vine_to_tree(&header, _spl_tree_to_vine(&header));
+    tree->_root = header._right_son;
+    tree->_root->_father = NULL;
+    return 0;
+}
+
+/**
+ * Merges two trees into a perfectly balanced one, in time linear in their
+ * sizes: both are turned into vines (see splay_rebalance), which are merged
+ * by key and compressed back into a tree. Nodes are moved from one tree to
+ * the other, not copied, so pointers to them stay valid.
+ * Options specify what to do with keys found in both trees (see header).
+ * The destination tree becomes the merged one and keeps its settings, while
+ * the source one is consumed and freed. Pools are dealt with as in splay_join:
+ * either both trees or none of them must have a node pool, and if they don't
+ * share the same one, the source tree's pool must not be shared with others.
+ *
+ * @param dst Pointer to the destination tree.
+ * @param src Pointer to the source tree.
+ * @param opts Options to configure the merge (see header).
+ * @return Pointer to the merged tree, NULL if the trees can't be merged.
+ */
+SplayTree *splay_merge(SplayTree *dst, SplayTree *src, int opts) {
+    // Sanity check on input arguments.
+    if ((dst == NULL) || (src == NULL) || (dst == src) || (opts <= 0) ||
+        !(opts & (MERGE_KEEP_LEFT | MERGE_KEEP_RIGHT | MERGE_KEEP_BOTH)))
+        return NULL;
+    if ((dst->_pool == NULL) != (src->_pool == NULL)) return NULL;
+    if ((dst->_pool != src->_pool) && _spl_pool_is_shared(src->_pool))
+        return NULL;
+    if (src->nodes_count > dst->max_nodes - dst->nodes_count) return NULL;
+    // Take care of the source tree's nodes pool first, so that the nodes that
+    // are dropped are given back to the right one.
+    if (src->_pool != NULL) {
+        if (src->_pool == dst->_pool) _spl_pool_release(src->_pool);
+        else _spl_pool_absorb(dst->_pool, src->_pool);
+    }
+    // Flatten both trees, then merge the vines.
+    SplayNode left = {0}, right = {0}, merged = {0};
+    left._right_son = dst->_root;
+    if (dst->_root != NULL) dst->_root->_father = &left;
+    right._right_son = src->_root;
+    if (src->_root != NULL) src->_root->_father = &right;
+    _spl_tree_to_vine(&left);
+    _spl_tree_to_vine(&right);
+    SplayNode *l = left._right_son, *r = right._right_son;
+    SplayNode *tail = &merged;
+    SplayNode *next, *dropped;
+    ulong count = 0;
+    int comp;
+    while ((l != NULL) || (r != NULL)) {
+        if (l == NULL) comp = 1;
+        else if (r == NULL) comp = -1;
+        else comp = SPL_KEY_CMP(l->_key, r->_key);
+        dropped = NULL;
+        if ((comp == 0) && (opts & MERGE_KEEP_LEFT)) {
+            dropped = r;
+            r = r->_right_son;
+        } else if ((comp == 0) && (opts & MERGE_KEEP_RIGHT)) {
+            dropped = l;
+            l = l->_right_son;
+        } else if (comp <= 0) {
+            next = l;
+            l = l->_right_son;
+        } else {
+            next = r;
+            r = r->_right_son;
+        }
+        if (dropped != NULL) {
+            if (opts & DELETE_FREE_KEYS) SPL_KEY_FREE(dropped->_key);
+            if (opts & DELETE_FREE_DATA) free(dropped->_data);
+            _spl_delete_node(dst, dropped);
+            continue;
+        }
+        tail->_right_son = next;
+        next->_father = tail;
+        tail = next;
+        count++;
+    }
+    tail->_right_son = NULL;
+    // Build the merged tree.
+    dst->_root = NULL;
+    if (count > 0) {
+        _spl_vine_to_tree(&merged, count);
+        dst->_root = merged._right_son;
+        dst->_root->_father = NULL;
+    }
+    dst->_finger = NULL;
+    dst->nodes_count = count;
+    free(src);
+    return dst;
+}
+
+/**
+ * Creates a new concurrent Splay Tree in the heap, wrapping a given tree
+ * which is then owned by the new one and must no longer be accessed directly.
+ *
+ * @param tree Pointer to the tree to wrap, NULL to create a new empty one.
+ * @return Pointer to the newly created tree, NULL if creation failed.
+ */
+SplaySyncTree *create_splay_sync_tree(SplayTree *tree) {
+    SplaySyncTree *new_stree =
+        (SplaySyncTree *)malloc(sizeof(SplaySyncTree));
+    if (new_stree == NULL) return NULL;
+    new_stree->_tree = (tree != NULL) ? tree : create_splay_tree();
+    if (new_stree->_tree == NULL) {
+        free(new_stree);
+        return NULL;
+    }
+    if (pthread_key_create(&(new_stree->_log_key),
+                           _spl_sync_log_destroy) != 0) {
+        if (tree == NULL) delete_splay_tree(new_stree->_tree, 0);
+        free(new_stree);
+        return NULL;
+    }
+    pthread_rwlock_init(&(new_stree->_lock), NULL);
+    pthread_mutex_init(&(new_stree->_logs_lock), NULL);
+    new_stree->_logs = NULL;
+    return new_stree;
+}
+
+/**
+ * Frees a given concurrent Splay Tree from the heap, together with the tree
+ * it wraps (see delete_splay_tree). No other thread must be using it.
+ *
+ * @param stree Pointer to the tree to free.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int delete_splay_sync_tree(SplaySyncTree *stree, int opts) {
+    // Sanity check on input arguments.
+    if ((stree == NULL) || (opts < 0)) return -1;
+    // From now on threads' logs are not released when they exit.
+    pthread_key_delete(stree->_log_key);
+    SplayAccessLog *curr = stree->_logs;
+    SplayAccessLog *next;
+    while (curr != NULL) {
+        next = curr->_next;
+        free(curr);
+        curr = next;
+    }
+    pthread_mutex_destroy(&(stree->_logs_lock));
+    pthread_rwlock_destroy(&(stree->_lock));
+    delete_splay_tree(stree->_tree, opts);
+    free(stree);
+    return 0;
+}
+
+/**
+ * Searches for an entry with the specified key in a concurrent tree, in
+ * parallel with other searches. If SEARCH_SPLAY is specified, the key is
+ * logged to be splayed later on (see header).
+ * Nodes returned with SEARCH_NODES can be deleted by other threads at any
+ * time, so they should be accessed only if that can't happen.
+ *
+ * @param stree Tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in a node (if any) or pointer to the node (if any).
+ */
+void *splay_sync_search(SplaySyncTree *stree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (stree == NULL)) return NULL;  // Sanity check.
+    pthread_rwlock_rdlock(&(stree->_lock));
+    SplayNode *node = (SplayNode *)splay_search(stree->_tree, key,
+                                                SEARCH_NODES);
+    void *res = NULL;
+    if (node != NULL) {
+        // The node's own key is logged, since it's kept at least until logs
+        // are applied, before any deletion.
+        if (opts & SEARCH_SPLAY) _spl_sync_log_access(stree, node->_key);
+        if (opts & SEARCH_DATA) res = node->_data;
+        else if (opts & SEARCH_NODES) res = (void *)node;
+    }
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Creates and inserts a new node in a concurrent tree, exclusively.
+ *
+ * @param stree Pointer to the tree to insert into.
+ * @param new_key New key to add to the dictionary.
+ * @param new_data New data to store into the dictionary.
+ * @return Internal nodes counter after the insertion, or 0 if full/bad args.
+ */
+ulong splay_sync_insert(SplaySyncTree *stree, SPL_KEY_ARG new_key,
+                        void *new_data) {
+    if (stree == NULL) return 0;  // Sanity check.
+    pthread_rwlock_wrlock(&(stree->_lock));
+    _spl_sync_apply_logs(stree);
+    ulong res = splay_insert(stree->_tree, new_key, new_data);
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Deletes an entry from a concurrent tree, exclusively.
+ *
+ * @param stree Pointer to the tree to delete from.
+ * @param key Key to delete from the dictionary.
+ * @param opts Also willing to free the stored data?
+ * @return 1 if found and deleted, 0 if not found or input args were bad.
+ */
+int splay_sync_delete(SplaySyncTree *stree, SPL_KEY_ARG key, int opts) {
+    if (stree == NULL) return 0;  // Sanity check.
+    pthread_rwlock_wrlock(&(stree->_lock));
+    _spl_sync_apply_logs(stree);
+    int res = splay_delete(stree->_tree, key, opts);
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Performs a depth-first search of a concurrent tree, in parallel with other
+ * searches (see splay_dfs).
+ *
+ * @param stree Pointer to the tree to operate on.
+ * @param type Type of DFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_sync_dfs(SplaySyncTree *stree, int type, int opts) {
+    if (stree == NULL) return NULL;  // Sanity check.
+    pthread_rwlock_rdlock(&(stree->_lock));
+    void **res = splay_dfs(stree->_tree, type, opts);
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Performs a breadth-first search of a concurrent tree, in parallel with
+ * other searches (see splay_bfs).
+ *
+ * @param stree Pointer to the tree to operate on.
+ * @param type Type of BFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_sync_bfs(SplaySyncTree *stree, int type, int opts) {
+    if (stree == NULL) return NULL;  // Sanity check.
+    pthread_rwlock_rdlock(&(stree->_lock));
+    void **res = splay_bfs(stree->_tree, type, opts);
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Splays all keys logged by searches on a concurrent tree, exclusively.
+ * Meant to be called periodically, e.g. by a background thread, on trees
+ * that are seldom modified.
+ *
+ * @param stree Pointer to the tree to operate on.
+ */
+void splay_sync_maintain(SplaySyncTree *stree) {
+    if (stree == NULL) return;  // Sanity check.
+    pthread_rwlock_wrlock(&(stree->_lock));
+    _spl_sync_apply_logs(stree);
+    pthread_rwlock_unlock(&(stree->_lock));
+}
+
+/**
+ * Creates a new sharded Splay Tree in the heap, made of a given number of
+ * empty concurrent trees, each one with its own node pool if a configuration
+ * for it is given (see header).
+ * By range, shard i holds keys in [bounds[i - 1], bounds[i]), the first one
+ * starting from the least key and the last one ending at the greatest one, so
+ * the bounds array must hold shards_count - 1 strictly increasing keys; if
+ * it's NULL, the whole range of keys is split evenly among shards, if the
+ * key type allows it (see the flavour's header). By hash, bounds are ignored.
+ *
+ * @param shards_count Number of shards to create.
+ * @param mode How keys are assigned to shards (see header).
+ * @param bounds Lower bounds of all shards but the first, can be NULL.
+ * @param pool_cfg Pointer to the pool configuration, NULL for no pool.
+ * @return Pointer to the newly created tree, NULL if creation failed.
+ */
+SplayShardTree *create_splay_shard_tree(
+    unsigned int shards_count, int mode, SPL_KEY_ARG const *bounds,
+    const SplayPoolConfig *pool_cfg) {
+    // Sanity check on input arguments.
+    if ((shards_count == 0) ||
+        !((mode & SHARD_BY_RANGE) || (mode & SHARD_BY_HASH)) ||
+        ((mode & SHARD_BY_RANGE) && (mode & SHARD_BY_HASH))) return NULL;
+    if ((mode & SHARD_BY_RANGE) && (bounds != NULL))
+        for (unsigned int i = 1; i + 1 < shards_count; i++)
+            if (SPL_KEY_CMP(SPL_KEY_MAKE(bounds[i]),
+                            SPL_KEY_MAKE(bounds[i - 1])) <= 0) return NULL;
+#ifndef SPL_KEY_SPLIT
+    if ((mode & SHARD_BY_RANGE) && (bounds == NULL) && (shards_count > 1))
+        return NULL;
+#endif
+    SplayShardTree *new_shtree =
+        (SplayShardTree *)malloc(sizeof(SplayShardTree));
+    if (new_shtree == NULL) return NULL;
+    new_shtree->_shards_count = shards_count;
+    new_shtree->_mode = mode & (SHARD_BY_RANGE | SHARD_BY_HASH);
+    new_shtree->_bounds = NULL;
+    new_shtree->_shards =
+        (SplaySyncTree **)calloc(shards_count, sizeof(SplaySyncTree *));
+    if (new_shtree->_shards == NULL) {
+        free(new_shtree);
+        return NULL;
+    }
+    // Compute the bounds of all shards.
+    if ((mode & SHARD_BY_RANGE) && (shards_count > 1)) {
+        new_shtree->_bounds =
+            (SPL_KEY *)malloc((shards_count - 1) * sizeof(SPL_KEY));
+        if (new_shtree->_bounds == NULL) {
+            delete_splay_shard_tree(new_shtree, 0);
+            return NULL;
+        }
+        for (unsigned int i = 0; i < shards_count - 1; i++)
+#ifdef SPL_KEY_SPLIT
+            new_shtree->_bounds[i] = (bounds != NULL) ?
+                SPL_KEY_MAKE(bounds[i]) : SPL_KEY_SPLIT(i, shards_count);
+#else
+            new_shtree->_bounds[i] = SPL_KEY_MAKE(bounds[i]);
+#endif
+    }
+    // Create the shards.
+    for (unsigned int i = 0; i < shards_count; i++) {
+        SplayTree *new_tree = create_splay_tree_ex(pool_cfg);
+        if (new_tree == NULL) {
+            delete_splay_shard_tree(new_shtree, 0);
+            return NULL;
+        }
+        new_shtree->_shards[i] = create_splay_sync_tree(new_tree);
+        if (new_shtree->_shards[i] == NULL) {
+            delete_splay_tree(new_tree, 0);
+            delete_splay_shard_tree(new_shtree, 0);
+            return NULL;
+        }
+    }
+    return new_shtree;
+}
+
+/**
+ * Frees a given sharded Splay Tree from the heap, together with all its
+ * shards (see delete_splay_tree). No other thread must be using it.
+ *
+ * @param shtree Pointer to the tree to free.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int delete_splay_shard_tree(SplayShardTree *shtree, int opts) {
+    // Sanity check on input arguments.
+    if ((shtree == NULL) || (opts < 0)) return -1;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++)
+        if (shtree->_shards[i] != NULL)
+            delete_splay_sync_tree(shtree->_shards[i], opts);
+    free(shtree->_shards);
+    free(shtree->_bounds);
+    free(shtree);
+    return 0;
+}
+
+/**
+ * Searches for an entry with the specified key in a sharded tree, in parallel
+ * with all other operations on different shards (see splay_sync_search).
+ *
+ * @param shtree Tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in a node (if any) or pointer to the node (if any).
+ */
+void *splay_shard_search(SplayShardTree *shtree, SPL_KEY_ARG key, int opts) {
+    if ((opts <= 0) || (shtree == NULL)) return NULL;  // Sanity check.
+    SplaySyncTree *shard =
+        shtree->_shards[_spl_shard_index(shtree, SPL_KEY_MAKE(key))];
+    return splay_sync_search(shard, key, opts);
+}
+
+/**
+ * Creates and inserts a new node in a sharded tree, locking only the shard
+ * the new key belongs to.
+ *
+ * @param shtree Pointer to the tree to insert into.
+ * @param new_key New key to add to the dictionary.
+ * @param new_data New data to store into the dictionary.
+ * @return Nodes counter of the shard after the insertion, or 0 if full/bad
+ *         args (see splay_shard_count for the total).
+ */
+ulong splay_shard_insert(SplayShardTree *shtree, SPL_KEY_ARG new_key,
+                         void *new_data) {
+    if (shtree == NULL) return 0;  // Sanity check.
+    SplaySyncTree *shard =
+        shtree->_shards[_spl_shard_index(shtree, SPL_KEY_MAKE(new_key))];
+    return splay_sync_insert(shard, new_key, new_data);
+}
+
+/**
+ * Deletes an entry from a sharded tree, locking only the shard its key
+ * belongs to.
+ *
+ * @param shtree Pointer to the tree to delete from.
+ * @param key Key to delete from the dictionary.
+ * @param opts Also willing to free the stored data?
+ * @return 1 if found and deleted, 0 if not found or input args were bad.
+ */
+int splay_shard_delete(SplayShardTree *shtree, SPL_KEY_ARG key, int opts) {
+    if (shtree == NULL) return 0;  // Sanity check.
+    SplaySyncTree *shard =
+        shtree->_shards[_spl_shard_index(shtree, SPL_KEY_MAKE(key))];
+    return splay_sync_delete(shard, key, opts);
+}
+
+/**
+ * Performs a depth-first search of a sharded tree, holding the locks of all
+ * shards for reading (see splay_dfs).
+ * In-order searches return all entries by increasing keys, merging shards if
+ * keys are spread by hash; other orders return the visits of all shards, one
+ * after the other.
+ *
+ * @param shtree Pointer to the tree to operate on.
+ * @param type Type of DFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_shard_dfs(SplayShardTree *shtree, int type, int opts) {
+    // Sanity check for the input arguments.
+    if ((shtree == NULL) || (type <= 0) || (opts <= 0)) return NULL;
+    int int_opt, order;
+    size_t entry_size;
+    if (opts & SEARCH_DATA) {
+        int_opt = SEARCH_DATA;
+        entry_size = sizeof(void *);
+    } else if (opts & SEARCH_KEYS) {
+        int_opt = SEARCH_KEYS;
+        entry_size = sizeof(SPL_KEY_ARG);
+    } else if (opts & SEARCH_NODES) {
+        int_opt = SEARCH_NODES;
+        entry_size = sizeof(SplayNode *);
+    } else return NULL;  // Invalid option.
+    if (type & DFS_PRE_ORDER) order = DFS_PRE_ORDER;
+    else if (type & DFS_IN_ORDER) order = DFS_IN_ORDER;
+    else if (type & DFS_POST_ORDER) order = DFS_POST_ORDER;
+    else return NULL;  // Invalid type.
+    // Lock all shards, always in the same order, and count their nodes.
+    ulong total = 0;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++) {
+        pthread_rwlock_rdlock(&(shtree->_shards[i]->_lock));
+        total += shtree->_shards[i]->_tree->nodes_count;
+    }
+    void **dfs_res = NULL;
+    if ((total > 0) && ((dfs_res = calloc(total, entry_size)) != NULL)) {
+        void *dst = (void *)dfs_res;
+        if ((order == DFS_IN_ORDER) && (shtree->_mode & SHARD_BY_HASH)) {
+            // Merge the in-order walks of all shards, which are already locked.
+            SplayShardIter iter;
+            SplayNode *node;
+            iter._shtree = shtree;
+            iter._opts = 0;
+            iter._iters = (SplayIter *)malloc(shtree->_shards_count *
+                                              sizeof(SplayIter));
+            if (iter._iters == NULL) {
+                free(dfs_res);
+                dfs_res = NULL;
+            } else {
+                for (unsigned int i = 0; i < shtree->_shards_count; i++)
+                    splay_iter_begin(shtree->_shards[i]->_tree,
+                                     &(iter._iters[i]), 0);
+                while ((node = _spl_shard_iter_pick(&iter)) != NULL) {
+                    dst = _spl_store_node(dst, node, int_opt);
+                    splay_iter_next(&(iter._iters[iter._shard]));
+                }
+                free(iter._iters);
+            }
+        } else {
+            for (unsigned int i = 0; i < shtree->_shards_count; i++)
+                dst = _spl_dfs_fill(shtree->_shards[i]->_tree->_root, order,
+                                    int_opt, dst);
+        }
+    }
+    for (unsigned int i = 0; i < shtree->_shards_count; i++)
+        pthread_rwlock_unlock(&(shtree->_shards[i]->_lock));
+    return dfs_res;
+}
+
+/**
+ * Counts the entries in a sharded tree, locking one shard at a time.
+ *
+ * @param shtree Pointer to the tree to operate on.
+ * @return Number of entries in all shards, 0 if input args were bad.
+ */
+ulong splay_shard_count(SplayShardTree *shtree) {
+    if (shtree == NULL) return 0;  // Sanity check.
+    ulong total = 0;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++) {
+        pthread_rwlock_rdlock(&(shtree->_shards[i]->_lock));
+        total += shtree->_shards[i]->_tree->nodes_count;
+        pthread_rwlock_unlock(&(shtree->_shards[i]->_lock));
+    }
+    return total;
+}
+
+/**
+ * Initializes an iterator on a sharded tree and returns the first node, by
+ * increasing keys or by decreasing keys if ITER_REVERSE is specified.
+ * Usage is the same as for (non-sharded) iterators, but the iterator must
+ * always be terminated to release the locks it's holding (see header).
+ *
+ * @param shtree Pointer to the tree to walk.
+ * @param iter Pointer to the iterator to initialize.
+ * @param opts Iteration options (see header).
+ * @return Pointer to the first node, or NULL if none or input args were bad.
+ */
+SplayNode *splay_shard_iter_begin(SplayShardTree *shtree,
+                                  SplayShardIter *iter, int opts) {
+    if (iter == NULL) return NULL;  // Sanity check.
+    iter->_shtree = NULL;
+    iter->_iters = NULL;
+    if ((shtree == NULL) || (opts < 0)) return NULL;
+    iter->_opts = opts;
+    if (shtree->_mode & SHARD_BY_RANGE) {
+        // Start from the first shard in the walk's direction.
+        iter->_shtree = shtree;
+        iter->_shard = (opts & ITER_REVERSE) ? shtree->_shards_count - 1 : 0;
+        SplaySyncTree *shard = shtree->_shards[iter->_shard];
+        pthread_rwlock_rdlock(&(shard->_lock));
+        return _spl_shard_iter_walk(
+            iter, splay_iter_begin(shard->_tree, &(iter->_iter), opts));
+    }
+    // Start from the first node of each shard.
+    iter->_iters =
+        (SplayIter *)malloc(shtree->_shards_count * sizeof(SplayIter));
+    if (iter->_iters == NULL) return NULL;
+    iter->_shtree = shtree;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++) {
+        pthread_rwlock_rdlock(&(shtree->_shards[i]->_lock));
+        splay_iter_begin(shtree->_shards[i]->_tree, &(iter->_iters[i]),
+                         opts);
+    }
+    return _spl_shard_iter_pick(iter);
+}
+
+/**
+ * Initializes an iterator on a sharded tree and returns the first node with a
+ * key greater than or equal to the given one, or less than or equal to it if
+ * ITER_REVERSE is specified. Meant for range scans, which can stop as soon as
+ * a key past the range is returned.
+ * By range, shards that precede the one the key belongs to are not locked.
+ *
+ * @param shtree Pointer to the tree to walk.
+ * @param iter Pointer to the iterator to initialize.
+ * @param key Key to start from.
+ * @param opts Iteration options (see header).
+ * @return Pointer to the first node, or NULL if none or input args were bad.
+ */
+SplayNode *splay_shard_iter_from(SplayShardTree *shtree,
+                                 SplayShardIter *iter, SPL_KEY_ARG key,
+                                 int opts) {
+    if (iter == NULL) return NULL;  // Sanity check.
+    iter->_shtree = NULL;
+    iter->_iters = NULL;
+    if ((shtree == NULL) || (opts < 0)) return NULL;
+    iter->_opts = opts;
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    if (shtree->_mode & SHARD_BY_RANGE) {
+        // Start from the shard the key belongs to.
+        iter->_shtree = shtree;
+        iter->_shard = _spl_shard_index(shtree, key_val);
+        SplaySyncTree *shard = shtree->_shards[iter->_shard];
+        pthread_rwlock_rdlock(&(shard->_lock));
+        iter->_iter._opts = opts;
+        iter->_iter._curr = (opts & ITER_REVERSE) ?
+            _spl_floor_bound(shard->_tree->_root, key_val) :
+            _spl_lower_bound(shard->_tree->_root, key_val);
+        return _spl_shard_iter_walk(iter, iter->_iter._curr);
+    }
+    // Start from the closest node in each shard.
+    iter->_iters =
+        (SplayIter *)malloc(shtree->_shards_count * sizeof(SplayIter));
+    if (iter->_iters == NULL) return NULL;
+    iter->_shtree = shtree;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++) {
+        SplaySyncTree *shard = shtree->_shards[i];
+        pthread_rwlock_rdlock(&(shard->_lock));
+        iter->_iters[i]._opts = opts;
+        iter->_iters[i]._curr = (opts & ITER_REVERSE) ?
+            _spl_floor_bound(shard->_tree->_root, key_val) :
+            _spl_lower_bound(shard->_tree->_root, key_val);
+    }
+    return _spl_shard_iter_pick(iter);
+}
+
+/**
+ * Moves an iterator on a sharded tree to the next node in its order, and
+ * returns it.
+ *
+ * @param iter Pointer to the iterator to advance.
+ * @return Pointer to the next node, or NULL if the walk is over.
+ */
+SplayNode *splay_shard_iter_next(SplayShardIter *iter) {
+    if ((iter == NULL) || (iter->_shtree == NULL)) return NULL;
+    if (iter->_shtree->_mode & SHARD_BY_RANGE) {
+        if (iter->_shard >= iter->_shtree->_shards_count) return NULL;
+        return _spl_shard_iter_walk(iter, splay_iter_next(&(iter->_iter)));
+    }
+    if (iter->_shard >= iter->_shtree->_shards_count) return NULL;
+    splay_iter_next(&(iter->_iters[iter->_shard]));
+    return _spl_shard_iter_pick(iter);
+}
+
+/**
+ * Terminates a walk on a sharded tree, releasing all locks and memory held by
+ * the iterator, which then returns no more nodes.
+ *
+ * @param iter Pointer to the iterator to terminate.
+ */
+void splay_shard_iter_end(SplayShardIter *iter) {
+    if ((iter == NULL) || (iter->_shtree == NULL)) return;
+    SplayShardTree *shtree = iter->_shtree;
+    if (shtree->_mode & SHARD_BY_RANGE) {
+        if (iter->_shard < shtree->_shards_count)
+            pthread_rwlock_unlock(&(shtree->_shards[iter->_shard]->_lock));
+    } else {
+        for (unsigned int i = 0; i < shtree->_shards_count; i++)
+            pthread_rwlock_unlock(&(shtree->_shards[i]->_lock));
+        free(iter->_iters);
+        iter->_iters = NULL;
+    }
+    iter->_shtree = NULL;
+}
+
+/**
+ * Creates a new compact Splay Tree in the heap (see header), with room for a
+ * given number of nodes that grows as needed.
+ *
+ * @param capacity Number of nodes to reserve memory for, 0 to do it later.
+ * @return Pointer to the newly created tree, NULL if allocation failed.
+ */
+SplayCompactTree *create_splay_compact_tree(ulong capacity) {
+    SplayCompactTree *new_ctree =
+        (SplayCompactTree *)malloc(sizeof(SplayCompactTree));
+    if (new_ctree == NULL) return NULL;
+    new_ctree->_nodes = NULL;
+    new_ctree->_data = NULL;
+    new_ctree->_root = 0;
+    new_ctree->_free_list = 0;
+    new_ctree->_used = 1;  // Index 0 is reserved.
+    new_ctree->_capacity = 0;
+    new_ctree->nodes_count = 0;
+    new_ctree->max_nodes = SPL_COMPACT_MAX_CAPACITY - 1;
+    new_ctree->_map = NULL;
+    new_ctree->_map_size = 0;
+    if ((capacity > 0) && (_spl_compact_grow(new_ctree, capacity + 1) != 0)) {
+        free(new_ctree);
+        return NULL;
+    }
+    return new_ctree;
+}
+
+/**
+ * Frees a given compact Splay Tree from the heap. Using options defined in
+ * the header, it's possible to specify whether also keys and data have to be
+ * freed or not.
+ *
+ * @param ctree Pointer to the tree to free.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int delete_splay_compact_tree(SplayCompactTree *ctree, int opts) {
+    // Sanity check on input arguments.
+    if ((ctree == NULL) || (opts < 0)) return -1;
+    if (ctree->_map != NULL) {
+        // Mapped trees own nothing but their mapping.
+        munmap(ctree->_map, (size_t)(ctree->_map_size));
+        free(ctree);
+        return 0;
+    }
+    // Released nodes have no data, so there's no need to walk the tree.
+    if (opts & DELETE_FREE_DATA)
+        for (unsigned int i = 1; i < ctree->_used; i++) free(ctree->_data[i]);
+    // Released nodes keep their old keys instead, so only the tree is walked,
+    // rotating left sons up so that no stack is needed.
+    if (opts & DELETE_FREE_KEYS) {
+        SplayCompactNode *nodes = ctree->_nodes;
+        unsigned int curr = ctree->_root, tmp;
+        while (curr != 0) {
+            if ((tmp = nodes[curr]._left_son) != 0) {
+                nodes[curr]._left_son = nodes[tmp]._right_son;
+                nodes[tmp]._right_son = curr;
+                curr = tmp;
+            } else {
+                SPL_KEY_FREE(nodes[curr]._key);
+                curr = nodes[curr]._right_son;
+            }
+        }
+    }
+    free(ctree->_nodes);
+    free(ctree->_data);
+    free(ctree);
+    return 0;
+}
+
+/**
+ * Searches for an entry with the specified key in a compact tree.
+ * Mapped trees are never splayed, even if SEARCH_SPLAY is specified.
+ *
+ * @param ctree Tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in a node, if any.
+ */
+void *splay_compact_search(SplayCompactTree *ctree, SPL_KEY_ARG key, int opts) {
+    // Sanity check on input arguments.
+    if ((opts <= 0) || (ctree == NULL) || (ctree->_root == 0)) return NULL;
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayCompactNode *nodes = ctree->_nodes;
+    unsigned int curr;
+    if ((opts & SEARCH_SPLAY) && (ctree->_map == NULL)) {
+        ctree->_root = _spl_compact_splay(nodes, ctree->_root, key_val);
+        curr = ctree->_root;
+        if (SPL_KEY_CMP(nodes[curr]._key, key_val) != 0) return NULL;
+    } else {
+        int comp;
+        curr = ctree->_root;
+        while ((curr != 0) &&
+               ((comp = SPL_KEY_CMP(key_val, nodes[curr]._key)) != 0))
+            curr = (comp < 0) ? nodes[curr]._left_son :
+                                nodes[curr]._right_son;
+        if (curr == 0) return NULL;
+    }
+    if (opts & SEARCH_DATA) return ctree->_data[curr];
+    return NULL;
+}
+
+/**
+ * Creates and inserts a new node in a compact tree.
+ *
+ * @param ctree Pointer to the tree to insert into.
+ * @param new_key New key to add to the dictionary.
+ * @param new_data New data to store into the dictionary.
+ * @return Internal nodes counter after the insertion, or 0 if full/bad args.
+ */
+ulong splay_compact_insert(SplayCompactTree *ctree, SPL_KEY_ARG new_key,
+                           void *new_data) {
+    if ((ctree == NULL) || (ctree->_map != NULL)) return 0;  // Sanity check.
+    if (ctree->nodes_count == ctree->max_nodes) return 0;  // The tree is full.
+    unsigned int new_node = _spl_compact_alloc(ctree);
+    if (new_node == 0) return 0;  // Allocation failed.
+    SplayCompactNode *nodes = ctree->_nodes;
+    nodes[new_node]._key = SPL_KEY_MAKE(new_key);
+    nodes[new_node]._left_son = 0;
+    nodes[new_node]._right_son = 0;
+    ctree->_data[new_node] = new_data;
+    if (ctree->_root != 0) {
+        // Splay the closest key to the root, then place the new node above it.
+        unsigned int old_root = _spl_compact_splay(nodes, ctree->_root,
+                                                   nodes[new_node]._key);
+        if (SPL_KEY_CMP(nodes[old_root]._key, nodes[new_node]._key) > 0) {
+            nodes[new_node]._left_son = nodes[old_root]._left_son;
+            nodes[old_root]._left_son = 0;
+            nodes[new_node]._right_son = old_root;
+        } else {
+            // Equals are kept in the left subtree.
+            nodes[new_node]._right_son = nodes[old_root]._right_son;
+            nodes[old_root]._right_son = 0;
+            nodes[new_node]._left_son = old_root;
+        }
+    }
+    ctree->_root = new_node;
+    ctree->nodes_count++;
+    return ctree->nodes_count;
+}
+
+/**
+ * Deletes an entry from a compact tree.
+ *
+ * @param ctree Pointer to the tree to delete from.
+ * @param key Key to delete from the dictionary.
+ * @param opts Also willing to free the stored data?
+ * @return 1 if found and deleted, 0 if not found or input args were bad.
+ */
+int splay_compact_delete(SplayCompactTree *ctree, SPL_KEY_ARG key, int opts) {
+    // Sanity check on input arguments.
+    if ((opts < 0) || (ctree == NULL) || (ctree->_root == 0) ||
+        (ctree->_map != NULL)) return 0;
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    SplayCompactNode *nodes = ctree->_nodes;
+    unsigned int to_delete = _spl_compact_splay(nodes, ctree->_root, key_val);
+    ctree->_root = to_delete;
+    if (SPL_KEY_CMP(nodes[to_delete]._key, key_val) != 0) return 0;
+    // Join the two subtrees of the root, splaying the largest key on the left.
+    unsigned int left_sub = nodes[to_delete]._left_son;
+    unsigned int right_sub = nodes[to_delete]._right_son;
+    if (left_sub == 0) {
+        ctree->_root = right_sub;
+    } else {
+        ctree->_root = _spl_compact_splay_max(nodes, left_sub);
+        nodes[ctree->_root]._right_son = right_sub;
+    }
+    // Apply eventual options to free keys and data, then release the node.
+    if (opts & DELETE_FREE_KEYS) SPL_KEY_FREE(nodes[to_delete]._key);
+    if (opts & DELETE_FREE_DATA) free(ctree->_data[to_delete]);
+    ctree->_data[to_delete] = NULL;
+    nodes[to_delete]._right_son = ctree->_free_list;
+    ctree->_free_list = to_delete;
+    ctree->nodes_count--;
+    return 1;
+}
+
+/**
+ * Performs a depth-first search of a compact tree, the type of which can be
+ * specified using the options defined in the header.
+ * Depending on the option specified, returns an array of:
+ * - Keys.
+ * - Data.
+ * Since nodes don't link to their fathers, a stack as deep as the tree is
+ * allocated for the walk.
+ * Remember to free the returned array afterwards!
+ *
+ * @param ctree Pointer to the tree to operate on.
+ * @param type Type of DFS to perform (see header).
+ * @param opts Type of data to return (see header).
+ * @return Pointer to an array with the result of the search correctly ordered.
+ */
+void **splay_compact_dfs(SplayCompactTree *ctree, int type, int opts) {
+    // Sanity check for the input arguments.
+    if ((type <= 0) || (opts <= 0)) return NULL;
+    if ((ctree == NULL) || (ctree->_root == 0)) return NULL;
+    if (!((type & DFS_PRE_ORDER) || (type & DFS_IN_ORDER) ||
+          (type & DFS_POST_ORDER))) return NULL;
+    int keys = 0;
+    if (opts & SEARCH_KEYS) keys = 1;
+    else if (!(opts & SEARCH_DATA)) return NULL;  // Invalid option.
+    void **dfs_res = calloc(ctree->nodes_count,
+                            keys ? sizeof(SPL_KEY_ARG) : sizeof(void *));
+    unsigned int *stack =
+        (unsigned int *)malloc(ctree->nodes_count * sizeof(unsigned int));
+    if ((dfs_res == NULL) || (stack == NULL)) {
+        free(dfs_res);
+        free(stack);
+        return NULL;
+    }
+    SplayCompactNode *nodes = ctree->_nodes;
+    SPL_KEY_ARG *key_ptr = (SPL_KEY_ARG *)dfs_res;
+    void **data_ptr = dfs_res;
+    ulong top = 0;
+    unsigned int curr = ctree->_root;
+    unsigned int last = 0;
+    unsigned int node;
+    while ((top > 0) || (curr != 0)) {
+        if (type & DFS_PRE_ORDER) {
+            // Visit the node, then go left and come back for the right son.
+            if (curr == 0) curr = stack[--top];
+            node = curr;
+            if (nodes[curr]._right_son != 0)
+                stack[top++] = nodes[curr]._right_son;
+            curr = nodes[curr]._left_son;
+        } else if (curr != 0) {
+            // Go down to the leftmost node, stacking the path.
+            stack[top++] = curr;
+            curr = nodes[curr]._left_son;
+            continue;
+        } else if (type & DFS_IN_ORDER) {
+            // Visit the node, then walk its right subtree.
+            node = stack[--top];
+            curr = nodes[node]._right_son;
+        } else {
+            // Walk the right subtree, if not done yet, then visit the node.
+            node = stack[top - 1];
+            if ((nodes[node]._right_son != 0) &&
+                (nodes[node]._right_son != last)) {
+                curr = nodes[node]._right_son;
+                continue;
+            }
+            top--;
+            last = node;
+        }
+        if (keys) *key_ptr++ = SPL_KEY_GET(nodes[node]._key);
+        else *data_ptr++ = ctree->_data[node];
+    }
+    free(stack);
+    return dfs_res;
+}
+
+/**
+ * Creates a frozen copy of a tree in the heap (see header), in linear time.
+ * The tree is walked in order without splaying, and is not modified.
+ *
+ * @param tree Pointer to the tree to freeze.
+ * @return Pointer to the frozen tree, NULL if allocation failed or input args
+ *         were bad.
+ */
+SplayFrozen *splay_freeze(SplayTree *tree) {
+    if (tree == NULL) return NULL;  // Sanity check.
+    ulong n = tree->nodes_count;
+    SplayFrozen *frozen = (SplayFrozen *)malloc(sizeof(SplayFrozen));
+    if (frozen == NULL) return NULL;
+    // Position 0 is not used, and the array is aligned to cache lines so that
+    // blocks of sons fall in the same one.
+    size_t size = (size_t)(n + 1) * sizeof(SPL_KEY);
+    size = (size + SPL_CACHE_LINE - 1) & ~((size_t)SPL_CACHE_LINE - 1);
+    frozen->_keys = (SPL_KEY *)aligned_alloc(SPL_CACHE_LINE, size);
+    frozen->_data = (void **)malloc((size_t)(n + 1) * sizeof(void *));
+    if ((frozen->_keys == NULL) || (frozen->_data == NULL)) {
+        free(frozen->_keys);
+        free(frozen->_data);
+        free(frozen);
+        return NULL;
+    }
+    frozen->nodes_count = n;
+    if (n == 0) return frozen;
+    // Visit positions in order, while walking the tree in order too.
+    SplayNode *curr = tree->_root;
+    SplayNode *prev = tree->_root->_father;
+    SplayNode *node;
+    ulong pos = _spl_frozen_next(n, 0);
+    while ((node = _spl_dfs_next(tree->_root, &curr, &prev,
+                                 DFS_IN_ORDER)) != NULL) {
+        frozen->_keys[pos] = node->_key;
+        frozen->_data[pos] = node->_data;
+        pos = _spl_frozen_next(n, pos);
+    }
+    return frozen;
+}
+
+/**
+ * Frees a given frozen Splay Tree from the heap. Keys and data are not freed,
+ * since they belong to the tree it was made from.
+ *
+ * @param frozen Pointer to the frozen tree to free.
+ * @return 0 if all went well, or -1 if input args were bad.
+ */
+int delete_splay_frozen(SplayFrozen *frozen) {
+    if (frozen == NULL) return -1;  // Sanity check.
+    free(frozen->_keys);
+    free(frozen->_data);
+    free(frozen);
+    return 0;
+}
+
+/**
+ * Searches for an entry with the specified key in a frozen tree.
+ * If there are many, the first one in key order is found.
+ *
+ * @param frozen Frozen tree to search into.
+ * @param key Key to look for.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the entry, if any.
+ */
+void *splay_frozen_search(SplayFrozen *frozen, SPL_KEY_ARG key, int opts) {
+    // Sanity check on input arguments.
+    if ((opts <= 0) || (frozen == NULL)) return NULL;
+    SPL_KEY key_val = SPL_KEY_MAKE(key);
+    ulong pos = _spl_frozen_bound(frozen, key_val, 0);
+    if ((pos == 0) || (SPL_KEY_CMP(frozen->_keys[pos], key_val) != 0))
+        return NULL;
+    if (opts & SEARCH_DATA) return frozen->_data[pos];
+    return NULL;
+}
+
+/**
+ * Looks for the entry with the greatest key less than or equal to the given
+ * one in a frozen tree.
+ *
+ * @param frozen Frozen tree to search into.
+ * @param key Key to look for.
+ * @param found_key Pointer to the location to return the key found into, can
+ *        be NULL.
+ * @param found_data Pointer to the location to return its data into, can be
+ *        NULL.
+ * @return 1 if an entry was found, 0 if none, -1 if input args were bad.
+ */
+int splay_frozen_floor(SplayFrozen *frozen, SPL_KEY_ARG key,
+                       SPL_KEY_ARG *found_key, void **found_data) {
+    if (frozen == NULL) return -1;  // Sanity check.
+    // This comes right before the first key greater than the given one.
+    ulong pos = _spl_frozen_prev(frozen->nodes_count,
+        _spl_frozen_bound(frozen, SPL_KEY_MAKE(key), 1));
+    if (pos == 0) return 0;
+    if (found_key != NULL) *found_key = SPL_KEY_GET(frozen->_keys[pos]);
+    if (found_data != NULL) *found_data = frozen->_data[pos];
+    return 1;
+}
+
+/**
+ * Looks for the entry with the least key greater than or equal to the given
+ * one in a frozen tree.
+ *
+ * @param frozen Frozen tree to search into.
+ * @param key Key to look for.
+ * @param found_key Pointer to the location to return the key found into, can
+ *        be NULL.
+ * @param found_data Pointer to the location to return its data into, can be
+ *        NULL.
+ * @return 1 if an entry was found, 0 if none, -1 if input args were bad.
+ */
+int splay_frozen_ceiling(SplayFrozen *frozen, SPL_KEY_ARG key,
+                         SPL_KEY_ARG *found_key, void **found_data) {
+    if (frozen == NULL) return -1;  // Sanity check.
+    ulong pos = _spl_frozen_bound(frozen, SPL_KEY_MAKE(key), 0);
+    if (pos == 0) return 0;
+    if (found_key != NULL) *found_key = SPL_KEY_GET(frozen->_keys[pos]);
+    if (found_data != NULL) *found_data = frozen->_data[pos];
+    return 1;
+}
+
+/**
+ * Visits, in key order, all entries of a frozen tree with keys in the closed
+ * interval [lo, hi], calling a callback on each one.
+ *
+ * @param frozen Frozen tree to look into.
+ * @param lo Least key in the range.
+ * @param hi Greatest key in the range.
+ * @param callback Function to call on each entry (see header), can be NULL.
+ * @param ctx Context pointer to pass to the callback.
+ * @return Number of entries visited, 0 if none or input args were bad.
+ */
+ulong splay_frozen_range(SplayFrozen *frozen, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                         SplayCallback callback, void *ctx) {
+    if (frozen == NULL) return 0;  // Sanity check.
+    SPL_KEY lo_val = SPL_KEY_MAKE(lo), hi_val = SPL_KEY_MAKE(hi);
+    if (SPL_KEY_CMP(lo_val, hi_val) > 0) return 0;
+    ulong pos = _spl_frozen_bound(frozen, lo_val, 0);
+    ulong count = 0;
+    while ((pos != 0) && (SPL_KEY_CMP(frozen->_keys[pos], hi_val) <= 0)) {
+        count++;
+        if ((callback != NULL) &&
+            callback(SPL_KEY_GET(frozen->_keys[pos]), frozen->_data[pos], ctx))
+            break;
+        pos = _spl_frozen_next(frozen->nodes_count, pos);
+    }
+    return count;
+}
+
+#ifdef SPL_KEY_PLAIN
+/**
+ * Saves a tree to a file as a snapshot (see header), starting from the file's
+ * current offset. The tree is not modified.
+ *
+ * @param tree Pointer to the tree to save.
+ * @param fd Descriptor of the file to write to.
+ * @return 0 if all went well, -1 if writing or allocation failed or input args
+ *         were bad.
+ */
+int splay_save(SplayTree *tree, int fd) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (fd < 0)) return -1;
+    if (tree->nodes_count >= SPL_COMPACT_MAX_CAPACITY) return -1;
+    ulong n = tree->nodes_count;
+    SplayCompactNode *nodes =
+        (SplayCompactNode *)calloc(n + 1, sizeof(SplayCompactNode));
+    void **data = (void **)calloc(n + 1, sizeof(void *));
+    if ((nodes == NULL) || (data == NULL)) {
+        free(nodes);
+        free(data);
+        return -1;
+    }
+    // Lay out keys and data by increasing keys.
+    SplayNode *curr = NULL;
+    if (tree->_root != NULL) curr = _spl_min_key_son(tree->_root);
+    for (ulong i = 1; curr != NULL; i++) {
+        nodes[i]._key = curr->_key;
+        data[i] = curr->_data;
+        curr = _spl_successor(curr);
+    }
+    int res = _spl_snapshot_write(fd, nodes, data, n);
+    free(nodes);
+    free(data);
+    return res;
+}
+
+/**
+ * Loads a tree from a snapshot (see header), starting from the file's current
+ * offset. Nodes are allocated at once, in a single chunk of the new tree's
+ * pool, and linked as a perfectly balanced tree in linear time, without
+ * comparing keys.
+ *
+ * @param fd Descriptor of the file to read from.
+ * @return Pointer to the new tree, NULL if reading or allocation failed or the
+ *         snapshot is not valid.
+ */
+SplayTree *splay_load(int fd) {
+    SplaySnapshot header;
+    SplayCompactNode *nodes;
+    void **data;
+    if (_spl_snapshot_read(fd, &header, &nodes, &data) != 0) return NULL;
+    SplayPoolConfig pool_cfg = {0};
+    SplayTree *new_tree = create_splay_tree_ex(&pool_cfg);
+    ulong n = header.nodes_count;
+    if ((new_tree != NULL) && (n > 0)) {
+        // Reserve all the nodes in a single chunk, then link them as in the
+        // snapshot: node i goes in position i - 1.
+        SplayChunk *chunk = _spl_pool_add_chunk(new_tree->_pool, n);
+        if (chunk == NULL) {
+            delete_splay_tree(new_tree, 0);
+            new_tree = NULL;
+        } else {
+            SplayNode *tree_nodes = SPL_CHUNK_NODES(chunk);
+            new_tree->_pool->_curr_used = n;
+            for (ulong i = 1; i <= n; i++) {
+                SplayNode *node = tree_nodes + (i - 1);
+                node->_key = nodes[i]._key;
+                node->_data = data[i];
+                node->_left_son = NULL;
+                node->_right_son = NULL;
+                if (nodes[i]._left_son != 0)
+                    _spl_insert_left_subtree(
+                        node, tree_nodes + (nodes[i]._left_son - 1));
+                if (nodes[i]._right_son != 0)
+                    _spl_insert_right_subtree(
+                        node, tree_nodes + (nodes[i]._right_son - 1));
+            }
+            new_tree->_root = tree_nodes + (header.root - 1);
+            new_tree->_root->_father = NULL;
+            new_tree->nodes_count = n;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+            _spl_size_fix_all(new_tree->_root);
+#endif
+        }
+    }
+    free(nodes);
+    free(data);
+    return new_tree;
+}
+
+/**
+ * Saves a compact tree to a file as a snapshot (see header), starting from
+ * the file's current offset. The tree is not modified.
+ *
+ * @param ctree Pointer to the tree to save.
+ * @param fd Descriptor of the file to write to.
+ * @return 0 if all went well, -1 if writing or allocation failed or input args
+ *         were bad.
+ */
+int splay_compact_save(SplayCompactTree *ctree, int fd) {
+    // Sanity check on input arguments.
+    if ((ctree == NULL) || (fd < 0)) return -1;
+    ulong n = ctree->nodes_count;
+    SplayCompactNode *nodes =
+        (SplayCompactNode *)calloc(n + 1, sizeof(SplayCompactNode));
+    void **data = (void **)calloc(n + 1, sizeof(void *));
+    unsigned int *stack =
+        (unsigned int *)malloc((n + 1) * sizeof(unsigned int));
+    if ((nodes == NULL) || (data == NULL) || (stack == NULL)) {
+        free(nodes);
+        free(data);
+        free(stack);
+        return -1;
+    }
+    // Lay out keys and data by increasing keys, with an in-order walk.
+    ulong i = 1, top = 0;
+    unsigned int curr = ctree->_root;
+    while ((top > 0) || (curr != 0)) {
+        if (curr != 0) {
+            stack[top++] = curr;
+            curr = ctree->_nodes[curr]._left_son;
+            continue;
+        }
+        curr = stack[--top];
+        nodes[i]._key = ctree->_nodes[curr]._key;
+        data[i++] = ctree->_data[curr];
+        curr = ctree->_nodes[curr]._right_son;
+    }
+    free(stack);
+    int res = _spl_snapshot_write(fd, nodes, data, n);
+    free(nodes);
+    free(data);
+    return res;
+}
+
+/**
+ * Loads a compact tree from a snapshot (see header), starting from the
+ * file's current offset. Since snapshots hold the layout of a compact tree,
+ * their contents are used as they are.
+ *
+ * @param fd Descriptor of the file to read from.
+ * @return Pointer to the new tree, NULL if reading or allocation failed or the
+ *         snapshot is not valid.
+ */
+SplayCompactTree *splay_compact_load(int fd) {
+    SplaySnapshot header;
+    SplayCompactNode *nodes;
+    void **data;
+    if (_spl_snapshot_read(fd, &header, &nodes, &data) != 0) return NULL;
+    SplayCompactTree *new_ctree = create_splay_compact_tree(0);
+    if (new_ctree == NULL) {
+        free(nodes);
+        free(data);
+        return NULL;
+    }
+    new_ctree->_nodes = nodes;
+    new_ctree->_data = data;
+    new_ctree->_root = header.root;
+    new_ctree->_used = (unsigned int)(header.nodes_count + 1);
+    new_ctree->_capacity = new_ctree->_used;
+    new_ctree->nodes_count = header.nodes_count;
+    return new_ctree;
+}
+
+/**
+ * Maps a snapshot in memory as a read-only compact tree (see header), without
+ * reading it: pages are loaded by the kernel as searches reach them, and can
+ * be shared by all processes mapping the same file. The snapshot must take
+ * the whole file, which can be closed right after this call.
+ * Apart from its header, the snapshot is not checked, so it must come from
+ * one of the save functions.
+ *
+ * @param fd Descriptor of the file to map.
+ * @return Pointer to the new tree, NULL if mapping or allocation failed or the
+ *         snapshot is not valid.
+ */
+SplayCompactTree *splay_compact_map(int fd) {
+    struct stat file_stat;
+    if ((fd < 0) || (fstat(fd, &file_stat) != 0) ||
+        ((size_t)file_stat.st_size < sizeof(SplaySnapshot))) return NULL;
+    size_t map_size = (size_t)file_stat.st_size;
+    void *map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) return NULL;
+    SplaySnapshot *header = (SplaySnapshot *)map;
+    ulong n = header->nodes_count;
+    if ((header->magic != SPL_SNAPSHOT_MAGIC) ||
+        (header->node_size != sizeof(SplayCompactNode)) ||
+        (header->data_size != sizeof(void *)) ||
+        (n >= SPL_COMPACT_MAX_CAPACITY) ||
+        (map_size < SPL_SNAPSHOT_DATA_OFFSET(n) + (n + 1) * sizeof(void *)) ||
+        (header->root > n) || ((n > 0) && (header->root == 0))) {
+        munmap(map, map_size);
+        return NULL;
+    }
+    SplayCompactTree *new_ctree = create_splay_compact_tree(0);
+    if (new_ctree == NULL) {
+        munmap(map, map_size);
+        return NULL;
+    }
+    new_ctree->_nodes =
+        (SplayCompactNode *)((char *)map + sizeof(SplaySnapshot));
+    new_ctree->_data = (void **)((char *)map + SPL_SNAPSHOT_DATA_OFFSET(n));
+    new_ctree->_root = header->root;
+    new_ctree->_used = (unsigned int)(n + 1);
+    new_ctree->_capacity = new_ctree->_used;
+    new_ctree->nodes_count = n;
+    new_ctree->max_nodes = n;
+    new_ctree->_map = map;
+    new_ctree->_map_size = map_size;
+    return new_ctree;
+}
+#endif
+
+/**
+ * Takes a snapshot of the statistics counters of a tree (see header).
+ * Can be called while other threads are searching the tree.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param stats Pointer to the location to copy the counters into.
+ * @return 0 if all went well, -1 if counters are not enabled or input args
+ *         were bad.
+ */
+int splay_stats(SplayTree *tree, SplayStats *stats) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (stats == NULL)) return -1;
+    *stats = (SplayStats){0};
+#ifdef SPLAY_ENABLE_STATS
+    _spl_stats_merge(stats, &(tree->_stats));
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Takes a snapshot of the statistics counters of a concurrent tree (see
+ * header), in parallel with other searches.
+ *
+ * @param stree Pointer to the tree to look into.
+ * @param stats Pointer to the location to copy the counters into.
+ * @return 0 if all went well, -1 if counters are not enabled or input args
+ *         were bad.
+ */
+int splay_sync_stats(SplaySyncTree *stree, SplayStats *stats) {
+    if (stree == NULL) return -1;  // Sanity check.
+    pthread_rwlock_rdlock(&(stree->_lock));
+    int res = splay_stats(stree->_tree, stats);
+    pthread_rwlock_unlock(&(stree->_lock));
+    return res;
+}
+
+/**
+ * Takes a snapshot of the statistics counters of a sharded tree (see
+ * header), locking one shard at a time. Counters of all shards are added up,
+ * apart from the maximum depth which is the greatest one among them.
+ *
+ * @param shtree Pointer to the tree to look into.
+ * @param stats Pointer to the location to copy the counters into.
+ * @return 0 if all went well, -1 if counters are not enabled or input args
+ *         were bad.
+ */
+int splay_shard_stats(SplayShardTree *shtree, SplayStats *stats) {
+    // Sanity check on input arguments.
+    if ((shtree == NULL) || (stats == NULL)) return -1;
+    *stats = (SplayStats){0};
+    SplayStats shard_stats;
+    for (unsigned int i = 0; i < shtree->_shards_count; i++) {
+        if (splay_sync_stats(shtree->_shards[i], &shard_stats) != 0)
+            return -1;
+        _spl_stats_merge(stats, &shard_stats);
+    }
+    return 0;
+}
+
+/**
+ * Measures the shape of a tree and the memory it takes (see header), without
+ * splaying and without any memory allocation. The tree is either walked
+ * whole, in linear time, or probed with random descents from the root, in
+ * time proportional to their number times the depth of the leaves reached.
+ * Can be called while other threads are searching the tree.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param shape Pointer to the location to store the measures into.
+ * @param data_size Size of the data of each entry, 0 if not known.
+ * @param samples Number of random descents to estimate the shape from, 0 to
+ *        walk the whole tree.
+ * @return 0 if all went well, -1 if input args were bad.
+ */
+int splay_shape_stats(SplayTree *tree, SplayShape *shape, ulong data_size,
+                      ulong samples) {
+    // Sanity check on input arguments.
+    if ((tree == NULL) || (shape == NULL)) return -1;
+    *shape = (SplayShape){0};
+    shape->nodes = tree->nodes_count;
+    shape->data_bytes = tree->nodes_count * data_size;
+    _spl_shape_memory(tree, shape);
+    if (tree->_root == NULL) return 0;
+    // Probing as many times as there are nodes is no faster than a walk.
+    if ((samples == 0) || (samples >= tree->nodes_count))
+        _spl_shape_walk(tree->_root, shape);
+    else _spl_shape_probe(tree->_root, shape, samples);
+    return 0;
+}
+
+// INTERNAL LIBRARY SUBROUTINES //
+/**
+ * Creates a new node in the heap, or in the tree's pool if it has one.
+ * Requires a key and some data. 
+ *
+ * @param tree Pointer to the tree the node is meant for.
+ * @param new_key Key to add.
+ * @param new_data Data to add.
+ * @return Pointer to a new node, or NULL if allocation failed.
+ */
+SplayNode *_spl_create_node(SplayTree *tree, SPL_KEY new_key,
+                            void *new_data) {
+    SplayNode *new_node;
+    if (tree->_pool != NULL) new_node = _spl_pool_alloc(tree->_pool);
+    else new_node = (SplayNode *)malloc(sizeof(SplayNode));
+    if (new_node == NULL) return NULL;
+    SPL_STAT_ADD(tree, allocations, 1);
+    new_node->_father = NULL;
+    new_node->_left_son = NULL;
+    new_node->_right_son = NULL;
+    new_node->_key = new_key;
+    new_node->_data = new_data;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    new_node->_size = 1;
+#endif
+    return new_node;
+}
+
+/**
+ * Frees memory occupied by a node, or gives it back to the tree's pool.
+ *
+ * @param tree Pointer to the tree the node comes from.
+ * @param node Node to release.
+ */
+void _spl_delete_node(SplayTree *tree, SplayNode *node) {
+    SPL_STAT_ADD(tree, frees, 1);
+    if (tree->_pool != NULL) _spl_pool_free(tree->_pool, node);
+    else free(node);
+}
+
+/**
+ * Frees keys and data of all nodes in a subtree, and eventually the nodes.
+ * This is done without any memory allocation and in linear time: left sons
+ * are rotated up until the root has none, so it can be dropped and its right
+ * son becomes the new root. The subtree is left in an inconsistent state.
+ *
+ * @param tree Pointer to the tree the subtree belongs to.
+ * @param root Root of the subtree to empty.
+ * @param opts Options to configure the deletion behaviour (see header).
+ * @param release Also release the nodes?
+ * @return Number of nodes in the subtree.
+ */
+ulong _spl_free_nodes(SplayTree *tree, SplayNode *root, int opts,
+                      int release) {
+    SplayNode *curr = root;
+    SplayNode *next;
+    ulong count = 0;
+    while (curr != NULL) {
+        if (curr->_left_son != NULL) {
+            // Rotate right, without caring for fathers.
+            next = curr->_left_son;
+            curr->_left_son = next->_right_son;
+            next->_right_son = curr;
+        } else {
+            next = curr->_right_son;
+            if (opts & DELETE_FREE_KEYS) SPL_KEY_FREE(curr->_key);
+            if (opts & DELETE_FREE_DATA) free(curr->_data);
+            if (release) _spl_delete_node(tree, curr);
+            count++;
+        }
+        curr = next;
+    }
+    return count;
+}
+
+/**
+ * Allocates a new chunk for a pool, and links it after the current one.
+ * The new chunk becomes the current one, from which nodes are carved.
+ *
+ * @param pool Pointer to the pool to expand.
+ * @param capacity Number of nodes the chunk must hold.
+ * @return Pointer to the new chunk, or NULL if allocation failed.
+ */
+SplayChunk *_spl_pool_add_chunk(SplayPool *pool, ulong capacity) {
+    SplayChunk *new_chunk =
+        (SplayChunk *)aligned_alloc(SPL_CACHE_LINE, SPL_CHUNK_SIZE(capacity));
+    if (new_chunk == NULL) return NULL;
+    new_chunk->_capacity = capacity;
+    if (pool->_curr_chunk == NULL) {
+        new_chunk->_next = pool->_chunks;
+        pool->_chunks = new_chunk;
+    } else {
+        new_chunk->_next = pool->_curr_chunk->_next;
+        pool->_curr_chunk->_next = new_chunk;
+    }
+    pool->_curr_chunk = new_chunk;
+    pool->_curr_used = 0;
+    return new_chunk;
+}
+
+/**
+ * Gets a node from a pool: released ones are reused first, then new ones are
+ * carved out of the current chunk. If that is full, the pool moves to the
+ * next one, allocating it if needed.
+ *
+ * @param pool Pointer to the pool to allocate from.
+ * @return Pointer to an uninitialized node, or NULL if allocation failed.
+ */
+SplayNode *_spl_pool_alloc(SplayPool *pool) {
+    if (pool->_shared) pthread_mutex_lock(&(pool->_lock));
+    SplayNode *new_node = pool->_free_list;
+    if (new_node != NULL) {
+        pool->_free_list = new_node->_right_son;
+    } else {
+        SplayChunk *chunk = pool->_curr_chunk;
+        if ((chunk != NULL) && (pool->_curr_used == chunk->_capacity) &&
+            (chunk->_next != NULL)) {
+            pool->_curr_chunk = chunk->_next;
+            pool->_curr_used = 0;
+        } else if ((chunk == NULL) || (pool->_curr_used == chunk->_capacity)) {
+            if (_spl_pool_add_chunk(pool, pool->_nodes_per_chunk) == NULL) {
+                if (pool->_shared) pthread_mutex_unlock(&(pool->_lock));
+                return NULL;
+            }
+        }
+        new_node = SPL_CHUNK_NODES(pool->_curr_chunk) + pool->_curr_used++;
+    }
+    if (pool->_shared) pthread_mutex_unlock(&(pool->_lock));
+    return new_node;
+}
+
+/**
+ * Gives a node back to its pool, to be reused by the next allocation.
+ *
+ * @param pool Pointer to the pool the node comes from.
+ * @param node Node to release.
+ */
+void _spl_pool_free(SplayPool *pool, SplayNode *node) {
+    if (pool->_shared) pthread_mutex_lock(&(pool->_lock));
+    node->_right_son = pool->_free_list;
+    pool->_free_list = node;
+    if (pool->_shared) pthread_mutex_unlock(&(pool->_lock));
+}
+
+/**
+ * Registers one more tree as a user of a pool. From then on, the pool is
+ * considered shared and its operations are serialized.
+ *
+ * @param pool Pointer to the pool to share.
+ */
+void _spl_pool_share(SplayPool *pool) {
+    if (pool->_shared) {
+        pthread_mutex_lock(&(pool->_lock));
+        pool->_refs++;
+        pthread_mutex_unlock(&(pool->_lock));
+    } else {
+        // No other tree can be using the pool right now.
+        pool->_refs++;
+        pool->_shared = 1;
+    }
+}
+
+/**
+ * Moves all chunks and free nodes of a pool, which must not be shared, into
+ * another one, then frees the former. Nodes that were still to be carved out
+ * of its chunks are added to the free list.
+ *
+ * @param dst Pointer to the pool to expand.
+ * @param src Pointer to the pool to move and free.
+ */
+void _spl_pool_absorb(SplayPool *dst, SplayPool *src) {
+    // Put unused nodes in the free list, and find the end of it.
+    SplayChunk *chunk = src->_curr_chunk;
+    ulong first = src->_curr_used;
+    while (chunk != NULL) {
+        for (ulong i = first; i < chunk->_capacity; i++) {
+            SPL_CHUNK_NODES(chunk)[i]._right_son = src->_free_list;
+            src->_free_list = SPL_CHUNK_NODES(chunk) + i;
+        }
+        chunk = chunk->_next;
+        first = 0;
+    }
+    SplayNode *free_tail = src->_free_list;
+    if (free_tail != NULL)
+        while (free_tail->_right_son != NULL) free_tail = free_tail->_right_son;
+    SplayChunk *chunks_tail = src->_chunks;
+    if (chunks_tail != NULL)
+        while (chunks_tail->_next != NULL) chunks_tail = chunks_tail->_next;
+    if (dst->_shared) pthread_mutex_lock(&(dst->_lock));
+    // All moved chunks are now full, so they must come before the current one.
+    if (chunks_tail != NULL) {
+        if (dst->_curr_chunk == NULL) {
+            dst->_curr_chunk = chunks_tail;
+            dst->_curr_used = chunks_tail->_capacity;
+        }
+        chunks_tail->_next = dst->_chunks;
+        dst->_chunks = src->_chunks;
+    }
+    if (free_tail != NULL) {
+        free_tail->_right_son = dst->_free_list;
+        dst->_free_list = src->_free_list;
+    }
+    if (dst->_shared) pthread_mutex_unlock(&(dst->_lock));
+    pthread_mutex_destroy(&(src->_lock));
+    free(src);
+}
+
+/**
+ * Unregisters a tree from a pool. Once no trees are using it, frees the pool
+ * and all its chunks, and thus every node allocated from it.
+ *
+ * @param pool Pointer to the pool to release.
+ */
+void _spl_pool_release(SplayPool *pool) {
+    if (pool->_shared) {
+        pthread_mutex_lock(&(pool->_lock));
+        int last = --(pool->_refs) == 0;
+        pthread_mutex_unlock(&(pool->_lock));
+        if (!last) return;
+    }
+    SplayChunk *curr = pool->_chunks;
+    SplayChunk *next;
+    while (curr != NULL) {
+        next = curr->_next;
+        free(curr);
+        curr = next;
+    }
+    pthread_mutex_destroy(&(pool->_lock));
+    free(pool);
+}
+
+/**
+ * Tells whether other trees are still using a pool. Once a pool has been
+ * shared, its operations stay serialized even if all other trees are gone,
+ * so this looks at how many of them are left instead.
+ *
+ * @param pool Pointer to the pool to check.
+ * @return 1 if more than one tree is using the pool, 0 otherwise.
+ */
+int _spl_pool_is_shared(SplayPool *pool) {
+    if (!pool->_shared) return 0;
+    pthread_mutex_lock(&(pool->_lock));
+    int shared = pool->_refs > 1;
+    pthread_mutex_unlock(&(pool->_lock));
+    return shared;
+}
+
+/**
+ * Climbs from a node to the lowest of its ancestors, itself included, which
+ * subtree must hold a given key if the tree does. Ancestors that are only
+ * passed through on the way are never compared.
+ *
+ * @param finger Node to start from.
+ * @param key Key to look for.
+ * @return Pointer to the root of the subtree to search.
+ */
+SplayNode *_spl_finger_climb(SplayNode *finger, SPL_KEY key) {
+    SplayNode *curr = finger;
+    SplayNode *bound;
+    int comp;
+    for (;;) {
+        comp = SPL_KEY_CMP(key, curr->_key);
+        if (comp == 0) return curr;
+        // Keys in this subtree are bounded, on the side of the key, by the
+        // closest ancestor this is on the other side of: if the key is beyond
+        // it, climb there.
+        bound = curr;
+        if (comp < 0) {
+            while ((bound->_father != NULL) &&
+                   (bound->_father->_left_son == bound))
+                bound = bound->_father;
+        } else {
+            while ((bound->_father != NULL) &&
+                   (bound->_father->_right_son == bound))
+                bound = bound->_father;
+        }
+        bound = bound->_father;
+        if (bound == NULL) return curr;
+        if ((comp < 0) ? (SPL_KEY_CMP(key, bound->_key) > 0) :
+                         (SPL_KEY_CMP(key, bound->_key) < 0)) return curr;
+        curr = bound;
+    }
+}
+
+/**
+ * Places a new node at the root of a tree, above the old root, which must
+ * hold the closest key to the new one (e.g. after a top-down splay). The old
+ * root is split between the two subtrees of the new one.
+ *
+ * @param tree Pointer to the tree to insert into.
+ * @param new_node Node to insert.
+ * @param old_root Root of the tree.
+ */
+void _spl_insert_root(SplayTree *tree, SplayNode *new_node,
+                      SplayNode *old_root) {
+    if (SPL_KEY_CMP(old_root->_key, new_node->_key) > 0) {
+        _spl_insert_left_subtree(new_node, _spl_cut_left_subtree(old_root));
+        _spl_insert_right_subtree(new_node, old_root);
+    } else {
+        // Equals are kept in the left subtree.
+        _spl_insert_right_subtree(new_node, _spl_cut_right_subtree(old_root));
+        _spl_insert_left_subtree(new_node, old_root);
+    }
+    SPL_SIZE_FIX(old_root);
+    SPL_SIZE_FIX(new_node);
+    tree->_root = new_node;
+}
+
+/**
+ * Looks for the node with a given key, creating and inserting it if there's
+ * none, then splays it. Only one descent is done either way.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param key Key to look for.
+ * @param data Data to store in the new node, if any.
+ * @param inserted Pointer to the location to return whether a node has been
+ *        inserted into.
+ * @return Pointer to the node, NULL if the tree is full or allocation failed.
+ */
+SplayNode *_spl_find_or_insert(SplayTree *tree, SPL_KEY key, void *data,
+                               int *inserted) {
+    SplayNode *new_node;
+    *inserted = 0;
+    if (tree->splay_opts & SPLAY_BOTTOM_UP) {
+        // Look for the node, keeping track of where it should go.
+        SplayNode *curr = tree->_root;
+        SplayNode *pred = NULL;
+        ulong depth = 0;
+        int comp = 0;
+        while (curr != NULL) {
+            comp = SPL_KEY_CMP(curr->_key, key);
+            if (comp == 0) break;
+            pred = curr;
+            curr = (comp > 0) ? curr->_left_son : curr->_right_son;
+            depth++;
+        }
+        SPL_STAT_DESCENT(tree, (curr != NULL) ? depth : depth - 1);
+        if (curr == NULL) {
+            if (tree->nodes_count == tree->max_nodes) {
+                // The entry evicted could be the one the new node should go
+                // under, so look again for its position.
+                if (!_spl_evict(tree, key)) return NULL;
+                return _spl_find_or_insert(tree, key, data, inserted);
+            }
+            curr = _spl_create_node(tree, key, data);
+            if (curr == NULL) return NULL;
+            if (pred == NULL) tree->_root = curr;
+            else if (comp > 0) _spl_insert_left_subtree(pred, curr);
+            else _spl_insert_right_subtree(pred, curr);
+            tree->nodes_count++;
+            *inserted = 1;
+        }
+        _spl_splay_node(tree, curr);
+        return curr;
+    }
+    if (tree->_root != NULL) {
+        tree->_root = _spl_td_splay(tree, tree->_root, key);
+        if (SPL_KEY_CMP(tree->_root->_key, key) == 0) return tree->_root;
+    }
+    // Not found: put a new node above the closest one, now the root.
+    // Evicting an entry leaves it there, unless it was the only one.
+    if ((tree->nodes_count == tree->max_nodes) && !_spl_evict(tree, key))
+        return NULL;
+    new_node = _spl_create_node(tree, key, data);
+    if (new_node == NULL) return NULL;
+    if (tree->_root != NULL) _spl_insert_root(tree, new_node, tree->_root);
+    else tree->_root = new_node;
+    tree->nodes_count++;
+    *inserted = 1;
+    return new_node;
+}
+
+/**
+ * Evicts an entry from a tree, to make room for a new key, if the tree is set
+ * up to do so (see SPLAY_EVICT). The leaf evicted is found following the
+ * descent of the new key, and then going on down through any son there is:
+ * this doesn't splay, so all other entries stay where they are.
+ *
+ * @param tree Pointer to the tree to evict from.
+ * @param key New key to make room for.
+ * @return 1 if an entry was evicted, 0 otherwise.
+ */
+int _spl_evict(SplayTree *tree, SPL_KEY key) {
+    if (!(tree->splay_opts & SPLAY_EVICT) || (tree->_root == NULL)) return 0;
+    SplayNode *victim = tree->_root;
+    SplayNode *first, *second;
+    ulong depth = 0;
+    while (1) {
+        // Equals are kept in the left subtree.
+        if (SPL_KEY_CMP(victim->_key, key) >= 0) {
+            first = victim->_left_son;
+            second = victim->_right_son;
+        } else {
+            first = victim->_right_son;
+            second = victim->_left_son;
+        }
+        if ((first == NULL) && (second == NULL)) break;
+        victim = (first != NULL) ? first : second;
+        depth++;
+    }
+    SPL_STAT_DESCENT(tree, depth);
+    // Cut the leaf off, then hand its entry over before releasing it.
+    SplayNode *father = victim->_father;
+    if (father == NULL) tree->_root = NULL;
+    else if (father->_left_son == victim) _spl_cut_left_subtree(father);
+    else _spl_cut_right_subtree(father);
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    _spl_size_fix_path(father);
+#endif
+    if (tree->_finger == victim) tree->_finger = NULL;
+    if (tree->evict_callback != NULL)
+        tree->evict_callback(SPL_KEY_GET(victim->_key), victim->_data,
+                             tree->evict_ctx);
+    _spl_delete_node(tree, victim);
+    tree->nodes_count--;
+    return 1;
+}
+
+/**
+ * Turns the tree hanging as the right son of a dummy node into a vine, i.e. a
+ * chain of right sons in key order, with right rotations.
+ *
+ * @param header Dummy node the tree hangs from.
+ * @return Number of nodes in the vine.
+ */
+ulong _spl_tree_to_vine(SplayNode *header) {
+    SplayNode *tail = header;
+    SplayNode *rest = header->_right_son;
+    ulong count = 0;
+    while (rest != NULL) {
+        if (rest->_left_son == NULL) {
+            // This is in place: move down the vine.
+            tail = rest;
+            rest = rest->_right_son;
+            count++;
+        } else {
+            // Rotate the left son up, into the vine.
+            SplayNode *son = rest->_left_son;
+            rest->_left_son = son->_right_son;
+            if (son->_right_son != NULL) son->_right_son->_father = rest;
+            son->_right_son = rest;
+            rest->_father = son;
+            tail->_right_son = son;
+            son->_father = tail;
+            rest = son;
+        }
+    }
+    return count;
+}
+
+/**
+ * Performs a compression pass on a vine hanging from a dummy node: the first
+ * nodes in it at odd positions are rotated left, each one becoming the left
+ * son of the one that followed it.
+ *
+ * @param header Dummy node the vine hangs from.
+ * @param count Number of rotations to perform.
+ */
+void _spl_vine_compress(SplayNode *header, ulong count) {
+    SplayNode *scanner = header;
+    SplayNode *son, *next;
+    for (ulong i = 0; i < count; i++) {
+        son = scanner->_right_son;
+        next = son->_right_son;
+        scanner->_right_son = next;
+        next->_father = scanner;
+        son->_right_son = next->_left_son;
+        if (son->_right_son != NULL) son->_right_son->_father = son;
+        next->_left_son = son;
+        son->_father = next;
+        scanner = next;
+    }
+}
+
+/**
+ * Turns a vine hanging from a dummy node into a perfectly balanced tree, with
+ * the compression passes of the Day-Stout-Warren algorithm: the nodes that
+ * don't fit in full levels go in the last one first, then each pass halves
+ * the length of the vine.
+ *
+ * @param header Dummy node the vine hangs from.
+ * @param count Number of nodes in the vine.
+ */
+void _spl_vine_to_tree(SplayNode *header, ulong count) {
+    ulong full = ((ulong)1 << _spl_floor_log2(count + 1)) - 1;
+    _spl_vine_compress(header, count - full);
+    for (ulong width = full / 2; width > 0; width /= 2)
+        _spl_vine_compress(header, width);
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    _spl_size_fix_all(header->_right_son);
+#endif
+}
+
+/**
+ * Computes the integer part of the base 2 logarithm of a number.
+ *
+ * @param n Number, must not be 0.
+ * @return Floor of log2(n).
+ */
+ulong _spl_floor_log2(ulong n) {
+    return (ulong)(8 * sizeof(ulong) - 1) - (ulong)__builtin_clzl(n);
+}
+
+/**
+ * Sorts the positions of a batch of keys by increasing keys, with a bottom-up
+ * merge sort which is stable, so that equal keys keep their order.
+ *
+ * @param keys Pointer to the keys.
+ * @param n Number of keys.
+ * @return Pointer to the sorted positions in the heap, NULL if n is 0 or
+ *         allocation failed.
+ */
+ulong *_spl_batch_order(SPL_KEY_ARG const *keys, ulong n) {
+    if (n == 0) return NULL;
+    SPL_KEY *stored = (SPL_KEY *)malloc(n * sizeof(SPL_KEY));
+    ulong *order = (ulong *)malloc(n * sizeof(ulong));
+    ulong *tmp = (ulong *)malloc(n * sizeof(ulong));
+    if ((stored == NULL) || (order == NULL) || (tmp == NULL)) {
+        free(stored);
+        free(order);
+        free(tmp);
+        return NULL;
+    }
+    for (ulong i = 0; i < n; i++) {
+        stored[i] = SPL_KEY_MAKE(keys[i]);
+        order[i] = i;
+    }
+    // Merge runs of doubling width, swapping the arrays at each pass.
+    for (ulong width = 1; width < n; width *= 2) {
+        for (ulong lo = 0; lo < n; lo += 2 * width) {
+            ulong mid = (width < n - lo) ? lo + width : n;
+            ulong hi = (2 * width < n - lo) ? lo + 2 * width : n;
+            ulong l = lo, r = mid, k = lo;
+            while ((l < mid) && (r < hi)) {
+                if (SPL_KEY_CMP(stored[order[r]], stored[order[l]]) < 0)
+                    tmp[k++] = order[r++];
+                else tmp[k++] = order[l++];
+            }
+            while (l < mid) tmp[k++] = order[l++];
+            while (r < hi) tmp[k++] = order[r++];
+        }
+        ulong *swap = order;
+        order = tmp;
+        tmp = swap;
+    }
+    free(stored);
+    free(tmp);
+    return order;
+}
+
+/**
+ * Searches for many keys without splaying, in groups that descend the tree
+ * together one level at a time, prefetching the next node of each search.
+ *
+ * @param tree Tree to search into.
+ * @param keys Pointer to the keys to look for.
+ * @param order Pointer to the order in which to search keys, or NULL.
+ * @param n Number of keys.
+ * @param out Pointer to the results array.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Number of keys found.
+ */
+ulong _spl_batch_descend(SplayTree *tree, SPL_KEY_ARG const *keys,
+                         const ulong *order, ulong n, void **out, int opts) {
+    SplayNode *curr[SPL_BATCH_WIDTH];
+    SPL_KEY key_vals[SPL_BATCH_WIDTH];
+    ulong pos[SPL_BATCH_WIDTH];
+    ulong depth[SPL_BATCH_WIDTH];
+    ulong found = 0;
+    int comp;
+    for (ulong base = 0; base < n; base += SPL_BATCH_WIDTH) {
+        int width = (n - base < SPL_BATCH_WIDTH) ? (int)(n - base) :
+                                                   SPL_BATCH_WIDTH;
+        for (int j = 0; j < width; j++) {
+            pos[j] = (order != NULL) ? order[base + j] : base + j;
+            key_vals[j] = SPL_KEY_MAKE(keys[pos[j]]);
+            curr[j] = tree->_root;
+            depth[j] = 0;
+            out[pos[j]] = NULL;
+        }
+        // Move each search one level down, until all of them are over.
+        int active = width;
+        while (active > 0) {
+            active = 0;
+            for (int j = 0; j < width; j++) {
+                SplayNode *node = curr[j];
+                if (node == NULL) continue;
+                comp = SPL_KEY_CMP(node->_key, key_vals[j]);
+                if (comp == 0) {
+                    SPL_STAT_DESCENT(tree, depth[j]);
+                    out[pos[j]] = (opts & SEARCH_DATA) ? node->_data :
+                                  ((opts & SEARCH_NODES) ? (void *)node :
+                                                           NULL);
+                    found++;
+                    curr[j] = NULL;
+                    continue;
+                }
+                curr[j] = (comp > 0) ? node->_left_son : node->_right_son;
+                if (curr[j] == NULL) {
+                    SPL_STAT_DESCENT(tree, depth[j]);
+                    continue;
+                }
+                __builtin_prefetch(curr[j]);
+                depth[j]++;
+                active++;
+            }
+        }
+    }
+    SPL_STAT_ADD(tree, searches, n);
+    SPL_STAT_ADD(tree, hits, found);
+    SPL_STAT_ADD(tree, misses, n - found);
+    return found;
+}
+
+/**
+ * Looks for the node with the closest key to a given one, in a given
+ * direction. Among equal keys, the farthest one in that direction is taken.
+ *
+ * @param tree Tree to search into.
+ * @param key Key to start from.
+ * @param greater Look for greater keys instead of lesser ones?
+ * @param strict Exclude keys equal to the given one?
+ * @param depth Pointer to the location to return the depth of the node into.
+ * @return Pointer to the node found, or NULL if there's none.
+ */
+SplayNode *_spl_nearest(SplayTree *tree, SPL_KEY key, int greater, int strict,
+                        ulong *depth) {
+    SplayNode *curr = tree->_root;
+    SplayNode *bound = NULL;
+    ulong curr_depth = 0;
+    int comp;
+    if (curr == NULL) return NULL;
+    while (curr != NULL) {
+        // Compare so that candidates are always on the positive side.
+        comp = SPL_KEY_CMP(curr->_key, key);
+        if (!greater) comp = -comp;
+        if ((comp > 0) || ((comp == 0) && !strict)) {
+            // This is a candidate, but a closer one could be further down.
+            bound = curr;
+            *depth = curr_depth;
+            curr = greater ? curr->_left_son : curr->_right_son;
+        } else curr = greater ? curr->_right_son : curr->_left_son;
+        curr_depth++;
+    }
+    SPL_STAT_DESCENT(tree, curr_depth - 1);
+    return bound;
+}
+
+/**
+ * Completes a search for the nearest key: splays the node found, as
+ * splay_search would, and returns what's been asked for.
+ *
+ * @param tree Tree that was searched.
+ * @param node Node found, or NULL if there's none.
+ * @param depth Depth of the node found.
+ * @param opts Configures the behaviour of the search operation (see header).
+ * @return Data stored in the node or pointer to the node, as requested.
+ */
+void *_spl_nearest_result(SplayTree *tree, SplayNode *node, ulong depth,
+                          int opts) {
+    SPL_STAT_ADD(tree, searches, 1);
+    if (node == NULL) {
+        SPL_STAT_ADD(tree, misses, 1);
+        return NULL;
+    }
+    SPL_STAT_ADD(tree, hits, 1);
+    _spl_splay_found(tree, node, depth, opts);
+    if (opts & SEARCH_DATA) return node->_data;
+    if (opts & SEARCH_NODES) return (void *)node;
+    return NULL;
+}
+
+/**
+ * Splays a node found by a search that walked down to it, if requested and
+ * as configured for the tree, as splay_search would.
+ *
+ * @param tree Tree that was searched.
+ * @param node Node found.
+ * @param depth Depth of the node found.
+ * @param opts Configures the behaviour of the search operation (see header).
+ */
+void _spl_splay_found(SplayTree *tree, SplayNode *node, ulong depth,
+                      int opts) {
+    int splay_mode = opts | tree->splay_opts;
+    if ((opts & SEARCH_SPLAY) &&
+        (!(splay_mode & SPLAY_DEPTH_LIMIT) || (depth > tree->splay_depth))) {
+        if (splay_mode & SPLAY_SEMI) _spl_semi_splay_node(tree, node);
+        else _spl_splay_node(tree, node);
+    }
+}
+
+/**
+ * Inserts a subtree rooted in a given node as the left subtree of a given 
+ * node.
+ *
+ * @param father Pointer to the node to root the subtree onto.
+ * @param new_son Root of the subtree to add.
+ */
+void _spl_insert_left_subtree(SplayNode *father, SplayNode *new_son) {
+    if (new_son != NULL) new_son->_father = father;
+    father->_left_son = new_son;
+}
+
+/**
+ * Inserts a subtree rooted in a given node as the right subtree of a given 
+ * node.
+ *
+ * @param father Pointer to the node to root the subtree onto.
+ * @param new_son Root of the subtree to add.
+ */
+void _spl_insert_right_subtree(SplayNode *father, SplayNode *new_son) {
+    if (new_son != NULL) new_son->_father = father;
+    father->_right_son = new_son;
+}
+
+/**
+ * Cuts and returns the left subtree of a given node.
+ *
+ * @param father Node to cut the subtree at.
+ * @return Pointer to the cut subtree's root.
+ */
+SplayNode *_spl_cut_left_subtree(SplayNode *father) {
+    SplayNode *son = father->_left_son;
+    if (son == NULL) return NULL;  // Sanity check.
+    son->_father = NULL;
+    father->_left_son = NULL;
+    return son;
+}
+
+/**
+ * Cuts and returns the right subtree of a given node.
+ *
+ * @param father Node to cut the subtree at.
+ * @return Pointer to the cut subtree's root.
+ */
+SplayNode *_spl_cut_right_subtree(SplayNode *father) {
+    SplayNode *son = father->_right_son;
+    if (son == NULL) return NULL;  // Sanity check.
+    son->_father = NULL;
+    father->_right_son = NULL;
+    return son;
+}
+
+/**
+ * Returns the descendant of a given node with the greatest key.
+ *
+ * @param node Node for which to look for the descendant.
+ * @return Pointer to the descendant node.
+ */
+SplayNode *_spl_max_key_son(SplayNode *node) {
+    SplayNode *curr = node;
+    while (curr->_right_son != NULL) curr = curr->_right_son;
+    return curr;
+}
+
+/**
+ * Returns the descendant of a given node with the least key.
+ *
+ * @param node Node for which to look for the descendant.
+ * @return Pointer to the descendant node.
+ */
+SplayNode *_spl_min_key_son(SplayNode *node) {
+    SplayNode *curr = node;
+    while (curr->_left_son != NULL) curr = curr->_left_son;
+    return curr;
+}
+
+/**
+ * Returns the node that follows a given one in key order, walking through
+ * the "father" pointers if required.
+ *
+ * @param node Node for which to look for the successor.
+ * @return Pointer to the successor, or NULL if the node has the greatest key.
+ */
+SplayNode *_spl_successor(SplayNode *node) {
+    if (node->_right_son != NULL) return _spl_min_key_son(node->_right_son);
+    // Climb until we come from a left son.
+    SplayNode *curr = node;
+    while ((curr->_father != NULL) && (curr->_father->_right_son == curr))
+        curr = curr->_father;
+    return curr->_father;
+}
+
+/**
+ * Returns the node that precedes a given one in key order, walking through
+ * the "father" pointers if required.
+ *
+ * @param node Node for which to look for the predecessor.
+ * @return Pointer to the predecessor, or NULL if the node has the least key.
+ */
+SplayNode *_spl_predecessor(SplayNode *node) {
+    if (node->_left_son != NULL) return _spl_max_key_son(node->_left_son);
+    // Climb until we come from a right son.
+    SplayNode *curr = node;
+    while ((curr->_father != NULL) && (curr->_father->_left_son == curr))
+        curr = curr->_father;
+    return curr->_father;
+}
+
+/**
+ * Returns a pointer to the node with the specified key, or NULL.
+ * If the library is compiled with SPLAY_ENABLE_PREFETCH defined, the descent
+ * prefetches both sons of each node and moves to the next one without
+ * branches, which pays off when the tree doesn't fit in caches.
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param key Key to look for.
+ * @param depth Pointer to store the depth of the node into, can be NULL.
+ * @return Pointer to the target node, or NULL if none or input args were bad.
+ */
+SplayNode *_spl_search_node(SplayTree *tree, SPL_KEY key, ulong *depth) {
+    if (tree->_root == NULL) return NULL;
+    return _spl_search_from(tree, tree->_root, key, depth);
+}
+
+/**
+ * Returns a pointer to the node with the specified key in the subtree rooted
+ * in a given node, or NULL (see _spl_search_node).
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param start Root of the subtree to look into, must not be NULL.
+ * @param key Key to look for.
+ * @param depth Pointer to store the depth of the node into, relative to the
+ *        subtree, or that of the last node reached if none, can be NULL.
+ * @return Pointer to the target node, or NULL if none.
+ */
+SplayNode *_spl_search_from(SplayTree *tree, SplayNode *start, SPL_KEY key,
+                            ulong *depth) {
+    SplayNode *curr = start;
+    ulong curr_depth = 0;
+    int comp;
+#ifdef SPLAY_ENABLE_PREFETCH
+    SplayNode *sons[2];
+#endif
+    while (curr != NULL) {
+#ifdef SPLAY_ENABLE_PREFETCH
+        // Both sons are requested from memory before comparing, so that the
+        // next one is already on its way, and is then picked without
+        // branching: only the exit upon a match is left, and it's rare.
+        sons[0] = curr->_left_son;
+        sons[1] = curr->_right_son;
+        __builtin_prefetch(sons[0]);
+        __builtin_prefetch(sons[1]);
+        comp = SPL_KEY_CMP(curr->_key, key);
+        if (__builtin_expect(comp == 0, 0)) break;
+        curr = sons[comp < 0];
+#else
+        comp = SPL_KEY_CMP(curr->_key, key);
+        if (comp > 0) {
+            curr = curr->_left_son;
+        } else if (comp < 0) {
+            curr = curr->_right_son;
+        } else break;
+#endif
+        curr_depth++;
+    }
+    if (curr == NULL) {
+        SPL_STAT_DESCENT(tree, curr_depth - 1);
+        if (depth != NULL) *depth = curr_depth - 1;
+        return NULL;
+    }
+    SPL_STAT_DESCENT(tree, curr_depth);
+    if (depth != NULL) *depth = curr_depth;
+    return curr;
+}
+
+/**
+ * Returns the first node, in key order, with a key greater than or equal to
+ * the given one. The subtree is not modified.
+ *
+ * @param root Root of the subtree to look into.
+ * @param key Key to look for.
+ * @return Pointer to the target node, or NULL if all keys are less than key.
+ */
+SplayNode *_spl_lower_bound(SplayNode *root, SPL_KEY key) {
+    SplayNode *curr = root;
+    SplayNode *bound = NULL;
+    while (curr != NULL) {
+        if (SPL_KEY_CMP(curr->_key, key) >= 0) {
+            // This is a candidate, but an equal or closer one could be left.
+            bound = curr;
+            curr = curr->_left_son;
+        } else curr = curr->_right_son;
+    }
+    return bound;
+}
+
+/**
+ * Returns the last node, in key order, with a key less than or equal to the
+ * given one. The subtree is not modified.
+ *
+ * @param root Root of the subtree to look into.
+ * @param key Key to look for.
+ * @return Pointer to the target node, or NULL if all keys are greater than key.
+ */
+SplayNode *_spl_floor_bound(SplayNode *root, SPL_KEY key) {
+    SplayNode *curr = root;
+    SplayNode *bound = NULL;
+    while (curr != NULL) {
+        if (SPL_KEY_CMP(curr->_key, key) <= 0) {
+            // This is a candidate, but an equal or closer one could be right.
+            bound = curr;
+            curr = curr->_right_son;
+        } else curr = curr->_left_son;
+    }
+    return bound;
+}
+
+/**
+ * Performs a simple right rotation at the specified node: its left son takes
+ * its place, and it becomes the right son of the former.
+ * Pointers are relinked, so nodes keep their contents.
+ *
+ * @param node Node to rotate onto.
+ */
+void _spl_right_rotation(SplayNode *node) {
+    SplayNode *left_son = node->_left_son;
+    SplayNode *father = node->_father;
+    // Hang the son where the node was.
+    left_son->_father = father;
+    if (father != NULL) {
+        if (father->_left_son == node) father->_left_son = left_son;
+        else father->_right_son = left_son;
+    }
+    // Recombine portions to respect the search property.
+    _spl_insert_left_subtree(node, left_son->_right_son);
+    _spl_insert_right_subtree(left_son, node);
+    SPL_SIZE_FIX(node);
+    SPL_SIZE_FIX(left_son);
+}
+
+/**
+ * Performs a simple left rotation at the specified node: its right son takes
+ * its place, and it becomes the left son of the former.
+ * Pointers are relinked, so nodes keep their contents.
+ *
+ * @param node Node to rotate onto.
+ */
+void _spl_left_rotation(SplayNode *node) {
+    SplayNode *right_son = node->_right_son;
+    SplayNode *father = node->_father;
+    // Hang the son where the node was.
+    right_son->_father = father;
+    if (father != NULL) {
+        if (father->_left_son == node) father->_left_son = right_son;
+        else father->_right_son = right_son;
+    }
+    // Recombine portions to respect the search property.
+    _spl_insert_right_subtree(node, right_son->_left_son);
+    _spl_insert_left_subtree(right_son, node);
+    SPL_SIZE_FIX(node);
+    SPL_SIZE_FIX(right_son);
+}
+
+/**
+ * Performs a single splay step onto a given node, which climbs by one or two
+ * levels.
+ * Note that in order to fully splay a node, this has to be called until a 
+ * node becomes the tree's root, which must then be updated by the caller.
+ *
+ * @param node Node to splay.
+ * @return Pointer to the splayed node.
+ */
+SplayNode *_spl_splay(SplayNode *node) {
+    // Consistency checks.
+    if (node == NULL) return NULL;
+    if (node->_father == NULL) return node;  // Nothing to do.
+    SplayNode *father_node = node->_father;
+    SplayNode *grand_node = father_node->_father;
+    if (grand_node == NULL) {
+        // Case 1: Father is the root. Rotate to climb accordingly.
+        if (father_node->_left_son == node) _spl_right_rotation(father_node);
+        else _spl_left_rotation(father_node);
+    } else if (father_node->_left_son == node) {
+        if (grand_node->_left_son == father_node) {
+            // Case 2: Both nodes are left sons.
+            // Rotate the father up first, then the node.
+            _spl_right_rotation(grand_node);
+            _spl_right_rotation(father_node);
+        } else {
+            // Case 4: Father is right son while this is a left son.
+            // Perform two rotations, on the father and on the grand node.
+            _spl_right_rotation(father_node);
+            _spl_left_rotation(grand_node);
+        }
+    } else {
+        if (grand_node->_right_son == father_node) {
+            // Case 3: Both nodes are right sons.
+            // Rotate the father up first, then the node.
+            _spl_left_rotation(grand_node);
+            _spl_left_rotation(father_node);
+        } else {
+            // Case 5: Father is left son while this is a right son.
+            // Perform two rotations, on the father and on the grand node.
+            _spl_left_rotation(father_node);
+            _spl_right_rotation(grand_node);
+        }
+    }
+    // The node always takes its father's or grand's place.
+    return node;
+}
+
+/**
+ * Fully splays a node bottom-up, making it the new root of its tree.
+ *
+ * @param tree Pointer to the tree the node is in.
+ * @param node Node to splay.
+ */
+void _spl_splay_node(SplayTree *tree, SplayNode *node) {
+    _spl_splay_subtree(tree, node);
+    tree->_root = node;
+}
+
+/**
+ * Fully splays a node bottom-up, making it the root of the subtree it is in,
+ * which may also have been cut off from its tree.
+ *
+ * @param tree Pointer to the tree to count splaying steps into.
+ * @param node Node to splay.
+ */
+void _spl_splay_subtree(SplayTree *tree, SplayNode *node) {
+    ulong steps = 0, rotations = 0;
+    while (node->_father != NULL) {
+        rotations += (node->_father->_father != NULL) ? 2 : 1;
+        steps++;
+        _spl_splay(node);
+    }
+    SPL_STAT_SPLAY(tree, steps, rotations);
+}
+
+/**
+ * Semi-splays a node (Sleator and Tarjan): when the node and its father are
+ * sons on the same side, only the father is rotated up, and the splay goes on
+ * from it. The node is thus only brought about halfway up its path, but the
+ * path is still shortened by half and rotations are cut.
+ *
+ * @param tree Pointer to the tree the node is in.
+ * @param node Node to semi-splay.
+ */
+void _spl_semi_splay_node(SplayTree *tree, SplayNode *node) {
+    SplayNode *father_node, *grand_node;
+    ulong steps = 0, rotations = 0;
+    while (node->_father != NULL) {
+        father_node = node->_father;
+        grand_node = father_node->_father;
+        steps++;
+        if ((grand_node != NULL) &&
+            ((father_node->_left_son == node) ==
+             (grand_node->_left_son == father_node))) {
+            // Zig-zig case: rotate only the father, then continue from it.
+            if (father_node->_left_son == node) _spl_right_rotation(grand_node);
+            else _spl_left_rotation(grand_node);
+            node = father_node;
+            rotations++;
+        } else {
+            rotations += (grand_node != NULL) ? 2 : 1;
+            _spl_splay(node);
+        }
+    }
+    tree->_root = node;
+    SPL_STAT_SPLAY(tree, steps, rotations);
+}
+
+/**
+ * Upon deletion, joins two subtrees and returns the new root.
+ *
+ * @param tree Pointer to the tree the subtrees come from.
+ * @param left_root Pointer to the root node of the left subtree.
+ * @param right_root Pointer to the root node of the right subtree.
+ * @return Pointer to the new root node.
+ */
+SplayNode *_spl_join(SplayTree *tree, SplayNode *left_root,
+                     SplayNode *right_root) {
+    // Easy cases: one or both subtrees are missing.
+    if ((left_root == NULL) && (right_root == NULL)) return NULL;
+    if (left_root == NULL) return right_root;
+    if (right_root == NULL) return left_root;
+    // Not-so-easy case: splay the largest-key node in the left subtree and
+    // then join the right as right subtree.
+    SplayNode *left_max = _spl_max_key_son(left_root);
+    ulong steps = 0, rotations = 0;
+    while (left_max->_father != NULL) {
+        rotations += (left_max->_father->_father != NULL) ? 2 : 1;
+        steps++;
+        _spl_splay(left_max);
+    }
+    SPL_STAT_SPLAY(tree, steps, rotations);
+    _spl_insert_right_subtree(left_max, right_root);
+    SPL_SIZE_FIX(left_max);
+    return left_max;
+}
+
+/**
+ * Recursively links a range of nodes in a balanced subtree, each one taking
+ * the entry in the same position of the keys and data arrays. The recursion
+ * depth is logarithmic in the number of nodes.
+ *
+ * @param nodes Pointer to the nodes array.
+ * @param keys Pointer to the sorted keys array.
+ * @param data Pointer to the data array, or NULL.
+ * @param first Position of the first node in the range.
+ * @param last Position of the last node in the range.
+ * @return Pointer to the root of the new subtree.
+ */
+SplayNode *_spl_build_balanced(SplayNode *nodes, SPL_KEY_ARG const *keys,
+                               void **data, ulong first, ulong last) {
+    ulong mid = first + (last - first) / 2;
+    SplayNode *root = nodes + mid;
+    root->_key = SPL_KEY_MAKE(keys[mid]);
+    root->_data = (data != NULL) ? data[mid] : NULL;
+    root->_left_son = NULL;
+    root->_right_son = NULL;
+    if (mid > first)
+        _spl_insert_left_subtree(
+            root, _spl_build_balanced(nodes, keys, data, first, mid - 1));
+    if (mid < last)
+        _spl_insert_right_subtree(
+            root, _spl_build_balanced(nodes, keys, data, mid + 1, last));
+    SPL_SIZE_FIX(root);
+    return root;
+}
+
+/**
+ * Performs a top-down splay of a subtree (Sleator and Tarjan), looking for a
+ * given key. Nodes are moved into a left and a right assembly tree while
+ * descending, so that the last node reached becomes the new root in the same
+ * pass. If the key is not present, the last node on its search path is
+ * splayed instead.
+ *
+ * @param tree Pointer to the tree the subtree is in.
+ * @param root Root of the subtree to splay, must not be NULL.
+ * @param key Key to look for.
+ * @return Pointer to the new root of the subtree.
+ */
+SplayNode *_spl_td_splay(SplayTree *tree, SplayNode *root, SPL_KEY key) {
+    // The assembly trees hang from a header node: its right son is the root of
+    // the left tree and vice versa.
+    SplayNode header;
+    SplayNode *left_max = &header, *right_min = &header;
+    SplayNode *curr = root;
+    SplayNode *tmp;
+    ulong depth = 0, steps = 0, rotations = 0;
+    int comp;
+    header._left_son = NULL;
+    header._right_son = NULL;
+    for (;;) {
+        comp = SPL_KEY_CMP(key, curr->_key);
+        if (comp < 0) {
+            if (curr->_left_son == NULL) break;
+            steps++;
+            if (SPL_KEY_CMP(key, curr->_left_son->_key) < 0) {
+                // Zig-zig: rotate right.
+                tmp = curr->_left_son;
+                _spl_insert_left_subtree(curr, tmp->_right_son);
+                _spl_insert_right_subtree(tmp, curr);
+                SPL_SIZE_FIX(curr);
+                curr = tmp;
+                depth++;
+                rotations++;
+                if (curr->_left_son == NULL) break;
+            }
+            // Link right: the current node is the new minimum of the right tree.
+            _spl_insert_left_subtree(right_min, curr);
+            right_min = curr;
+            curr = curr->_left_son;
+            depth++;
+        } else if (comp > 0) {
+            if (curr->_right_son == NULL) break;
+            steps++;
+            if (SPL_KEY_CMP(key, curr->_right_son->_key) > 0) {
+                // Zag-zag: rotate left.
+                tmp = curr->_right_son;
+                _spl_insert_right_subtree(curr, tmp->_left_son);
+                _spl_insert_left_subtree(tmp, curr);
+                SPL_SIZE_FIX(curr);
+                curr = tmp;
+                depth++;
+                rotations++;
+                if (curr->_right_son == NULL) break;
+            }
+            // Link left: the current node is the new maximum of the left tree.
+            _spl_insert_right_subtree(left_max, curr);
+            left_max = curr;
+            curr = curr->_right_son;
+            depth++;
+        } else break;
+    }
+    SPL_STAT_DESCENT(tree, depth);
+    SPL_STAT_SPLAY(tree, steps, rotations);
+    // Reassemble: the sons of the last node close the assembly trees, which
+    // then become its new subtrees.
+    _spl_insert_right_subtree(left_max, curr->_left_son);
+    _spl_insert_left_subtree(right_min, curr->_right_son);
+    _spl_insert_left_subtree(curr, header._right_son);
+    _spl_insert_right_subtree(curr, header._left_son);
+    curr->_father = NULL;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    // Sizes of the nodes linked into the assembly trees are fixed from their
+    // maximum (or minimum) up, along the paths they now form.
+    if (left_max != &header) _spl_size_fix_path(left_max);
+    if (right_min != &header) _spl_size_fix_path(right_min);
+    SPL_SIZE_FIX(curr);
+#endif
+    return curr;
+}
+
+/**
+ * Performs a top-down splay of the node with the greatest key in a subtree.
+ * The new root has no right son.
+ *
+ * @param tree Pointer to the tree the subtree is in.
+ * @param root Root of the subtree to splay, must not be NULL.
+ * @return Pointer to the new root of the subtree.
+ */
+SplayNode *_spl_td_splay_max(SplayTree *tree, SplayNode *root) {
+    SplayNode header;
+    SplayNode *left_max = &header;
+    SplayNode *curr = root;
+    SplayNode *tmp;
+    ulong steps = 0;
+    header._right_son = NULL;
+    while (curr->_right_son != NULL) {
+        // Zag-zag: rotate left.
+        tmp = curr->_right_son;
+        _spl_insert_right_subtree(curr, tmp->_left_son);
+        _spl_insert_left_subtree(tmp, curr);
+        SPL_SIZE_FIX(curr);
+        curr = tmp;
+        steps++;
+        if (curr->_right_son == NULL) break;
+        // Link left.
+        _spl_insert_right_subtree(left_max, curr);
+        left_max = curr;
+        curr = curr->_right_son;
+    }
+    // Reassemble: there's no right tree here.
+    _spl_insert_right_subtree(left_max, curr->_left_son);
+    _spl_insert_left_subtree(curr, header._right_son);
+    curr->_father = NULL;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    if (left_max != &header) _spl_size_fix_path(left_max);
+    SPL_SIZE_FIX(curr);
+#endif
+    SPL_STAT_SPLAY(tree, steps, steps);
+    return curr;
+}
+
+/**
+ * Performs a top-down splay of the node with the least key in a subtree.
+ * The new root has no left son.
+ *
+ * @param tree Pointer to the tree the subtree is in.
+ * @param root Root of the subtree to splay, must not be NULL.
+ * @return Pointer to the new root of the subtree.
+ */
+SplayNode *_spl_td_splay_min(SplayTree *tree, SplayNode *root) {
+    SplayNode header;
+    SplayNode *right_min = &header;
+    SplayNode *curr = root;
+    SplayNode *tmp;
+    ulong steps = 0;
+    header._left_son = NULL;
+    while (curr->_left_son != NULL) {
+        // Zig-zig: rotate right.
+        tmp = curr->_left_son;
+        _spl_insert_left_subtree(curr, tmp->_right_son);
+        _spl_insert_right_subtree(tmp, curr);
+        SPL_SIZE_FIX(curr);
+        curr = tmp;
+        steps++;
+        if (curr->_left_son == NULL) break;
+        // Link right.
+        _spl_insert_left_subtree(right_min, curr);
+        right_min = curr;
+        curr = curr->_left_son;
+    }
+    // Reassemble: there's no left tree here.
+    _spl_insert_left_subtree(right_min, curr->_right_son);
+    _spl_insert_right_subtree(curr, header._left_son);
+    curr->_father = NULL;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    if (right_min != &header) _spl_size_fix_path(right_min);
+    SPL_SIZE_FIX(curr);
+#endif
+    SPL_STAT_SPLAY(tree, steps, steps);
+    return curr;
+}
+
+/**
+ * Splays the node with the greatest key in a non-empty tree, as configured
+ * for the tree. The new root has no right son.
+ *
+ * @param tree Pointer to the tree to splay.
+ * @return Pointer to the new root.
+ */
+SplayNode *_spl_splay_max(SplayTree *tree) {
+    if (tree->splay_opts & SPLAY_BOTTOM_UP)
+        _spl_splay_node(tree, _spl_max_key_son(tree->_root));
+    else tree->_root = _spl_td_splay_max(tree, tree->_root);
+    return tree->_root;
+}
+
+/**
+ * Splays the node with the least key in a non-empty tree, as configured for
+ * the tree. The new root has no left son.
+ *
+ * @param tree Pointer to the tree to splay.
+ * @return Pointer to the new root.
+ */
+SplayNode *_spl_splay_min(SplayTree *tree) {
+    if (tree->splay_opts & SPLAY_BOTTOM_UP)
+        _spl_splay_node(tree, _spl_min_key_son(tree->_root));
+    else tree->_root = _spl_td_splay_min(tree, tree->_root);
+    return tree->_root;
+}
+
+/**
+ * Splays the last node, in key order, with a key less than or equal to the
+ * given one in a non-empty tree, so that all greater keys end up in the
+ * right subtree of the root. If there's no such node, the tree is still
+ * splayed but no node is returned.
+ *
+ * @param tree Pointer to the tree to splay.
+ * @param key Key to look for.
+ * @return Pointer to the new root, or NULL if all keys are greater than key.
+ */
+SplayNode *_spl_splay_floor(SplayTree *tree, SPL_KEY key) {
+    SplayNode *floor, *next;
+    if (!(tree->splay_opts & SPLAY_BOTTOM_UP)) {
+        // The new root is either the closest key or an equal one, but more
+        // equal ones could follow it.
+        tree->_root = _spl_td_splay(tree, tree->_root, key);
+        floor = tree->_root;
+        if (SPL_KEY_CMP(floor->_key, key) > 0)
+            floor = _spl_predecessor(floor);
+        else while (((next = _spl_successor(floor)) != NULL) &&
+                    (SPL_KEY_CMP(next->_key, key) <= 0)) floor = next;
+    } else floor = _spl_floor_bound(tree->_root, key);
+    if ((floor != NULL) && (floor != tree->_root)) _spl_splay_node(tree, floor);
+    return floor;
+}
+
+/**
+ * Counts the nodes in the left one of two detached subtrees, given the total
+ * number of nodes in both. The two are walked side by side, so that this
+ * takes time linear in the size of the smallest one.
+ *
+ * @param left_root Root of the left subtree.
+ * @param right_root Root of the right subtree.
+ * @param total Number of nodes in both subtrees.
+ * @return Number of nodes in the left subtree.
+ */
+ulong _spl_count_left(SplayNode *left_root, SplayNode *right_root,
+                      ulong total) {
+    SplayNode *l_curr = left_root, *l_prev = NULL;
+    SplayNode *r_curr = right_root, *r_prev = NULL;
+    ulong l_count = 0, r_count = 0;
+    for (;;) {
+        if (_spl_dfs_next(left_root, &l_curr, &l_prev, DFS_PRE_ORDER) == NULL)
+            return l_count;
+        l_count++;
+        if (_spl_dfs_next(right_root, &r_curr, &r_prev, DFS_PRE_ORDER) == NULL)
+            return total - r_count;
+        r_count++;
+    }
+}
+
+/**
+ * Records a key in the calling thread's access log for a concurrent tree,
+ * creating and registering the log upon the first access. Must be called
+ * while holding the lock for reading: since each thread only writes to its
+ * own log, no further synchronization is required.
+ * If the log can't be created, the access is simply not recorded.
+ *
+ * @param stree Pointer to the tree that has been accessed.
+ * @param key Key to record.
+ */
+void _spl_sync_log_access(SplaySyncTree *stree, SPL_KEY key) {
+    SplayAccessLog *log =
+        (SplayAccessLog *)pthread_getspecific(stree->_log_key);
+    if (log == NULL) {
+        log = (SplayAccessLog *)malloc(sizeof(SplayAccessLog));
+        if (log == NULL) return;
+        log->_owner = stree;
+        log->_count = 0;
+        if (pthread_setspecific(stree->_log_key, log) != 0) {
+            free(log);
+            return;
+        }
+        pthread_mutex_lock(&(stree->_logs_lock));
+        log->_next = stree->_logs;
+        if (log->_next != NULL) log->_next->_prev_next = &(log->_next);
+        log->_prev_next = &(stree->_logs);
+        stree->_logs = log;
+        pthread_mutex_unlock(&(stree->_logs_lock));
+    }
+    // Older keys get overwritten.
+    log->_keys[log->_count % SPLAY_SYNC_LOG_SIZE] = key;
+    log->_count++;
+}
+
+/**
+ * Unregisters and frees an access log, when the thread it belongs to exits.
+ *
+ * @param log Pointer to the log to free.
+ */
+void _spl_sync_log_destroy(void *log) {
+    SplayAccessLog *access_log = (SplayAccessLog *)log;
+    SplaySyncTree *stree = access_log->_owner;
+    pthread_mutex_lock(&(stree->_logs_lock));
+    *(access_log->_prev_next) = access_log->_next;
+    if (access_log->_next != NULL)
+        access_log->_next->_prev_next = access_log->_prev_next;
+    pthread_mutex_unlock(&(stree->_logs_lock));
+    free(access_log);
+}
+
+/**
+ * Splays all keys recorded in the access logs of a concurrent tree, from the
+ * oldest to the most recent in each log, then empties them. Must be called
+ * while holding the lock for writing, so that no thread can be recording.
+ * Keys that have been deleted in the meantime are skipped.
+ *
+ * @param stree Pointer to the tree to splay.
+ */
+void _spl_sync_apply_logs(SplaySyncTree *stree) {
+    pthread_mutex_lock(&(stree->_logs_lock));
+    for (SplayAccessLog *log = stree->_logs; log != NULL; log = log->_next) {
+        ulong first = 0;
+        if (log->_count > SPLAY_SYNC_LOG_SIZE)
+            first = log->_count - SPLAY_SYNC_LOG_SIZE;
+        for (ulong i = first; i < log->_count; i++)
+            splay_search(stree->_tree,
+                         SPL_KEY_GET(log->_keys[i % SPLAY_SYNC_LOG_SIZE]),
+                         SEARCH_SPLAY | SEARCH_NODES);
+        log->_count = 0;
+    }
+    pthread_mutex_unlock(&(stree->_logs_lock));
+}
+
+/**
+ * Upon deletion, joins two subtrees and returns the new root, splaying
+ * top-down.
+ *
+ * @param tree Pointer to the tree the subtrees come from.
+ * @param left_root Pointer to the root node of the left subtree.
+ * @param right_root Pointer to the root node of the right subtree.
+ * @return Pointer to the new root node.
+ */
+SplayNode *_spl_td_join(SplayTree *tree, SplayNode *left_root,
+                        SplayNode *right_root) {
+    if (left_root == NULL) return right_root;
+    if (right_root == NULL) return left_root;
+    // Bring the largest key in the left subtree to its root, which is then
+    // left without a right son.
+    left_root = _spl_td_splay_max(tree, left_root);
+    _spl_insert_right_subtree(left_root, right_root);
+    SPL_SIZE_FIX(left_root);
+    return left_root;
+}
+
+/**
+ * Performs a single step of an iterative DFS of a subtree, moving through the
+ * "father" pointers when climbing back. The walk is fully described by the
+ * node it's at and the one it came from, so it requires no stack and can be
+ * suspended and resumed at any time, in linear time overall no matter the
+ * shape of the tree.
+ * To start a walk, set the current node to the subtree's root and the
+ * previous one to the root's father.
+ *
+ * @param root_node Root of the subtree to walk.
+ * @param curr Pointer to the node the walk is at, NULL once it's over.
+ * @param prev Pointer to the node the walk came from.
+ * @param order DFS order, only one of the DFS options (see header).
+ * @return Pointer to the next node in the requested order, or NULL.
+ */
+SplayNode *_spl_dfs_next(SplayNode *root_node, SplayNode **curr,
+                         SplayNode **prev, int order) {
+    SplayNode *node, *next, *visited;
+    while (*curr != NULL) {
+        node = *curr;
+        visited = NULL;
+        if (*prev == node->_father) {
+            // Coming from above: visit the left subtree first.
+            if (order == DFS_PRE_ORDER) visited = node;
+            if (node->_left_son != NULL) {
+                next = node->_left_son;
+            } else {
+                if (order == DFS_IN_ORDER) visited = node;
+                if (node->_right_son != NULL) {
+                    next = node->_right_son;
+                } else {
+                    if (order == DFS_POST_ORDER) visited = node;
+                    next = NULL;
+                }
+            }
+        } else if (*prev == node->_left_son) {
+            // Coming from the left subtree: visit the right one.
+            if (order == DFS_IN_ORDER) visited = node;
+            if (node->_right_son != NULL) {
+                next = node->_right_son;
+            } else {
+                if (order == DFS_POST_ORDER) visited = node;
+                next = NULL;
+            }
+        } else {
+            // Coming from the right subtree: this one is done.
+            if (order == DFS_POST_ORDER) visited = node;
+            next = NULL;
+        }
+        // No son to go down to means climbing back, unless at the root.
+        if ((next == NULL) && (node != root_node)) next = node->_father;
+        *prev = node;
+        *curr = next;
+        if (visited != NULL) return visited;
+    }
+    return NULL;
+}
+
+/**
+ * Stores what's requested of a node in a DFS or BFS result array.
+ *
+ * @param dst Pointer to the next free position in the array.
+ * @param node Node to store.
+ * @param int_opt Internal options passed value.
+ * @return Pointer to the position that follows the stored entry.
+ */
+void *_spl_store_node(void *dst, SplayNode *node, int int_opt) {
+    if (int_opt & SEARCH_KEYS) {
+        *(SPL_KEY_ARG *)dst = SPL_KEY_GET(node->_key);
+        return (void *)((SPL_KEY_ARG *)dst + 1);
+    }
+    if (int_opt & SEARCH_NODES) *(void **)dst = node;
+    else if (int_opt & SEARCH_DATA) *(void **)dst = node->_data;
+    return (void *)((void **)dst + 1);
+}
+
+/**
+ * Performs a full DFS of a subtree, storing what's requested of each node
+ * in an array.
+ *
+ * @param root_node Root of the subtree to walk.
+ * @param order DFS order, only one of the DFS options (see header).
+ * @param int_opt Internal options passed value.
+ * @param dst Pointer to the first free position in the array.
+ * @return Pointer to the position that follows the last stored entry.
+ */
+void *_spl_dfs_fill(SplayNode *root_node, int order, int int_opt,
+                    void *dst) {
+    if (root_node == NULL) return dst;
+    SplayNode *curr = root_node;
+    SplayNode *prev = root_node->_father;
+    SplayNode *node;
+    while ((node = _spl_dfs_next(root_node, &curr, &prev, order)) != NULL)
+        dst = _spl_store_node(dst, node, int_opt);
+    return dst;
+}
+
+/**
+ * Converts the options of a walk into a buffer into internal options.
+ *
+ * @param opts Type of data to return (see header).
+ * @return Internal options passed value, 0 if opts are invalid.
+ */
+int _spl_walk_opts(int opts) {
+    if (opts <= 0) return 0;
+    if (opts & SEARCH_DATA) return SEARCH_DATA;
+    if (opts & SEARCH_KEYS) return SEARCH_KEYS;
+    if (opts & SEARCH_NODES) return SEARCH_NODES;
+    return 0;
+}
+
+/**
+ * Finds the first node at a given depth in a subtree, in BFS order, without
+ * any allocation: the subtree is walked depth-first, never going down past
+ * that depth and climbing back through the "father" pointers.
+ *
+ * @param sub_root Root of the subtree to look into.
+ * @param depth Depth of the node to find, relative to the subtree's root.
+ * @param type Type of BFS, only one of the BFS options (see header).
+ * @return Pointer to the first node at that depth, or NULL if there's none.
+ */
+SplayNode *_spl_level_first(SplayNode *sub_root, ulong depth, int type) {
+    if (sub_root == NULL) return NULL;
+    SplayNode *curr = sub_root;
+    SplayNode *first, *second;
+    ulong curr_depth = 0;
+    while (1) {
+        if (curr_depth == depth) return curr;
+        // Go down to the first son there is.
+        first = (type == BFS_LEFT_FIRST) ? curr->_left_son : curr->_right_son;
+        second = (type == BFS_LEFT_FIRST) ? curr->_right_son : curr->_left_son;
+        if ((first != NULL) || (second != NULL)) {
+            curr = (first != NULL) ? first : second;
+            curr_depth++;
+            continue;
+        }
+        // Climb back until there's a second son not visited yet.
+        while (1) {
+            if (curr == sub_root) return NULL;
+            second = (type == BFS_LEFT_FIRST) ? curr->_father->_right_son :
+                                               curr->_father->_left_son;
+            if ((second != NULL) && (second != curr)) {
+                curr = second;
+                break;
+            }
+            curr = curr->_father;
+            curr_depth--;
+        }
+    }
+}
+
+/**
+ * Finds the node that follows a given one on the same level of a tree, in
+ * BFS order, climbing back from it and looking into the subtrees on its
+ * side at the same depth.
+ *
+ * @param root_node Root of the tree.
+ * @param node Node to start from.
+ * @param type Type of BFS, only one of the BFS options (see header).
+ * @return Pointer to the next node on the same level, or NULL if it's over.
+ */
+SplayNode *_spl_level_next(SplayNode *root_node, SplayNode *node, int type) {
+    SplayNode *curr = node;
+    SplayNode *second, *next;
+    ulong up = 0;
+    while (curr != root_node) {
+        second = (type == BFS_LEFT_FIRST) ? curr->_father->_right_son :
+                                           curr->_father->_left_son;
+        if ((second != NULL) && (second != curr)) {
+            next = _spl_level_first(second, up, type);
+            if (next != NULL) return next;
+        }
+        curr = curr->_father;
+        up++;
+    }
+    return NULL;
+}
+
+/**
+ * Returns the index of the shard a key belongs to in a sharded tree.
+ * By hash, keys are spread with Fibonacci hashing, then mapped to shards
+ * with a multiplication rather than a division.
+ *
+ * @param shtree Pointer to the sharded tree.
+ * @param key Key to look for.
+ * @return Index of the shard.
+ */
+unsigned int _spl_shard_index(SplayShardTree *shtree, SPL_KEY key) {
+    if (shtree->_mode & SHARD_BY_HASH) {
+        unsigned int hash = (unsigned int)SPL_KEY_HASH(key) * 0x9E3779B1U;
+        return (unsigned int)(((unsigned long long int)hash *
+                               shtree->_shards_count) >> 32);
+    }
+    // Look for the first bound greater than the key.
+    unsigned int lo = 0, hi = shtree->_shards_count - 1;
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (SPL_KEY_CMP(shtree->_bounds[mid], key) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Moves an iterator on a tree sharded by range past the shards it has
+ * exhausted, releasing their locks and taking those of the following ones,
+ * until a node is found or there are no more shards.
+ *
+ * @param iter Pointer to the iterator to advance.
+ * @param node Node reached in the current shard, NULL if it's exhausted.
+ * @return Pointer to the next node, or NULL if the walk is over.
+ */
+SplayNode *_spl_shard_iter_walk(SplayShardIter *iter,
+                                SplayNode *node) {
+    SplayShardTree *shtree = iter->_shtree;
+    while (node == NULL) {
+        pthread_rwlock_unlock(&(shtree->_shards[iter->_shard]->_lock));
+        if (iter->_opts & ITER_REVERSE) {
+            if (iter->_shard == 0) {
+                iter->_shard = shtree->_shards_count;
+                return NULL;
+            }
+            iter->_shard--;
+        } else if (++(iter->_shard) == shtree->_shards_count) return NULL;
+        SplaySyncTree *shard = shtree->_shards[iter->_shard];
+        pthread_rwlock_rdlock(&(shard->_lock));
+        node = splay_iter_begin(shard->_tree, &(iter->_iter),
+                                iter->_opts);
+    }
+    return node;
+}
+
+/**
+ * Picks the next node for an iterator on a tree sharded by hash among the
+ * current ones of all shards, i.e. the one with the least key, or with the
+ * greatest one if the walk is reversed, and remembers its shard.
+ *
+ * @param iter Pointer to the iterator to advance.
+ * @return Pointer to the next node, or NULL if the walk is over.
+ */
+SplayNode *_spl_shard_iter_pick(SplayShardIter *iter) {
+    SplayNode *next = NULL;
+    iter->_shard = iter->_shtree->_shards_count;
+    for (unsigned int i = 0; i < iter->_shtree->_shards_count; i++) {
+        SplayNode *curr = iter->_iters[i]._curr;
+        if (curr == NULL) continue;
+        if ((next == NULL) ||
+            ((iter->_opts & ITER_REVERSE) ?
+             (SPL_KEY_CMP(curr->_key, next->_key) > 0) :
+             (SPL_KEY_CMP(curr->_key, next->_key) < 0))) {
+            next = curr;
+            iter->_shard = i;
+        }
+    }
+    return next;
+}
+
+/**
+ * Atomically raises a statistics counter to a given value, if it's less.
+ *
+ * @param counter Pointer to the counter to update.
+ * @param value New value for the counter.
+ */
+void _spl_stat_max(ulong *counter, ulong value) {
+    ulong curr = __atomic_load_n(counter, __ATOMIC_RELAXED);
+    while ((curr < value) &&
+           !__atomic_compare_exchange_n(counter, &curr, value, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**
+ * Adds a set of statistics counters to another one, reading each of the
+ * former atomically. Maximum depths are compared instead.
+ *
+ * @param dst Pointer to the counters to update.
+ * @param src Pointer to the counters to add.
+ */
+void _spl_stats_merge(SplayStats *dst, const SplayStats *src) {
+    ulong depth_max = __atomic_load_n(&(src->depth_max), __ATOMIC_RELAXED);
+    dst->searches += __atomic_load_n(&(src->searches), __ATOMIC_RELAXED);
+    dst->hits += __atomic_load_n(&(src->hits), __ATOMIC_RELAXED);
+    dst->misses += __atomic_load_n(&(src->misses), __ATOMIC_RELAXED);
+    dst->descents += __atomic_load_n(&(src->descents), __ATOMIC_RELAXED);
+    dst->depth_total += __atomic_load_n(&(src->depth_total), __ATOMIC_RELAXED);
+    if (depth_max > dst->depth_max) dst->depth_max = depth_max;
+    dst->splays += __atomic_load_n(&(src->splays), __ATOMIC_RELAXED);
+    dst->splay_steps += __atomic_load_n(&(src->splay_steps), __ATOMIC_RELAXED);
+    dst->rotations += __atomic_load_n(&(src->rotations), __ATOMIC_RELAXED);
+    dst->allocations += __atomic_load_n(&(src->allocations), __ATOMIC_RELAXED);
+    dst->frees += __atomic_load_n(&(src->frees), __ATOMIC_RELAXED);
+}
+
+/**
+ * Takes a free node from a compact tree, from its free list or from the
+ * unused part of its array, which is grown if needed.
+ *
+ * @param ctree Pointer to the tree to take the node from.
+ * @return Index of the new node, or 0 if allocation failed.
+ */
+unsigned int _spl_compact_alloc(SplayCompactTree *ctree) {
+    unsigned int new_node = ctree->_free_list;
+    if (new_node != 0) {
+        ctree->_free_list = ctree->_nodes[new_node]._right_son;
+        return new_node;
+    }
+    if (ctree->_used >= ctree->_capacity) {
+        // Double the arrays, up to the greatest possible index.
+        ulong capacity = (ulong)ctree->_capacity * 2;
+        if (capacity < SPL_COMPACT_MIN_CAPACITY)
+            capacity = SPL_COMPACT_MIN_CAPACITY;
+        if (capacity > SPL_COMPACT_MAX_CAPACITY)
+            capacity = SPL_COMPACT_MAX_CAPACITY;
+        if ((capacity == ctree->_capacity) ||
+            (_spl_compact_grow(ctree, capacity) != 0)) return 0;
+    }
+    return ctree->_used++;
+}
+
+/**
+ * Grows the arrays of a compact tree to a given number of nodes.
+ *
+ * @param ctree Pointer to the tree to grow.
+ * @param capacity New number of nodes, must be greater than the current one.
+ * @return 0 if all went well, -1 if allocation failed or capacity is too big.
+ */
+int _spl_compact_grow(SplayCompactTree *ctree, ulong capacity) {
+    if (capacity > SPL_COMPACT_MAX_CAPACITY) return -1;
+    SplayCompactNode *new_nodes = (SplayCompactNode *)realloc(
+        ctree->_nodes, capacity * sizeof(SplayCompactNode));
+    if (new_nodes == NULL) return -1;
+    ctree->_nodes = new_nodes;
+    void **new_data = (void **)realloc(ctree->_data, capacity * sizeof(void *));
+    if (new_data == NULL) return -1;  // The nodes array is just bigger.
+    ctree->_data = new_data;
+    ctree->_capacity = (unsigned int)capacity;
+    return 0;
+}
+
+/**
+ * Performs a top-down splay of a subtree of a compact tree, looking for a
+ * given key (see _spl_td_splay). Node 0 is used as the header node for the
+ * assembly trees, since its sons are never looked at otherwise.
+ *
+ * @param nodes Pointer to the nodes array.
+ * @param root Index of the root of the subtree, must not be 0.
+ * @param key Key to look for.
+ * @return Index of the new root of the subtree.
+ */
+unsigned int _spl_compact_splay(SplayCompactNode *nodes, unsigned int root,
+                                SPL_KEY key) {
+    unsigned int left_max = 0, right_min = 0;
+    unsigned int curr = root;
+    unsigned int tmp;
+    int comp;
+    nodes[0]._left_son = 0;
+    nodes[0]._right_son = 0;
+    for (;;) {
+        comp = SPL_KEY_CMP(key, nodes[curr]._key);
+        if (comp < 0) {
+            tmp = nodes[curr]._left_son;
+            if (tmp == 0) break;
+            if (SPL_KEY_CMP(key, nodes[tmp]._key) < 0) {
+                // Zig-zig: rotate right.
+                nodes[curr]._left_son = nodes[tmp]._right_son;
+                nodes[tmp]._right_son = curr;
+                curr = tmp;
+                if (nodes[curr]._left_son == 0) break;
+            }
+            // Link right.
+            nodes[right_min]._left_son = curr;
+            right_min = curr;
+            curr = nodes[curr]._left_son;
+        } else if (comp > 0) {
+            tmp = nodes[curr]._right_son;
+            if (tmp == 0) break;
+            if (SPL_KEY_CMP(key, nodes[tmp]._key) > 0) {
+                // Zag-zag: rotate left.
+                nodes[curr]._right_son = nodes[tmp]._left_son;
+                nodes[tmp]._left_son = curr;
+                curr = tmp;
+                if (nodes[curr]._right_son == 0) break;
+            }
+            // Link left.
+            nodes[left_max]._right_son = curr;
+            left_max = curr;
+            curr = nodes[curr]._right_son;
+        } else break;
+    }
+    // Reassemble.
+    nodes[left_max]._right_son = nodes[curr]._left_son;
+    nodes[right_min]._left_son = nodes[curr]._right_son;
+    nodes[curr]._left_son = nodes[0]._right_son;
+    nodes[curr]._right_son = nodes[0]._left_son;
+    return curr;
+}
+
+/**
+ * Performs a top-down splay of the node with the greatest key in a subtree
+ * of a compact tree. The new root has no right son.
+ *
+ * @param nodes Pointer to the nodes array.
+ * @param root Index of the root of the subtree, must not be 0.
+ * @return Index of the new root of the subtree.
+ */
+unsigned int _spl_compact_splay_max(SplayCompactNode *nodes,
+                                    unsigned int root) {
+    unsigned int left_max = 0;
+    unsigned int curr = root;
+    unsigned int tmp;
+    nodes[0]._right_son = 0;
+    while ((tmp = nodes[curr]._right_son) != 0) {
+        // Zag-zag: rotate left.
+        nodes[curr]._right_son = nodes[tmp]._left_son;
+        nodes[tmp]._left_son = curr;
+        curr = tmp;
+        if (nodes[curr]._right_son == 0) break;
+        // Link left.
+        nodes[left_max]._right_son = curr;
+        left_max = curr;
+        curr = nodes[curr]._right_son;
+    }
+    // Reassemble: there's no right tree here.
+    nodes[left_max]._right_son = nodes[curr]._left_son;
+    nodes[curr]._left_son = nodes[0]._right_son;
+    return curr;
+}
+
+/**
+ * Finds the first key in a frozen tree that is greater than or equal to the
+ * given one, or strictly greater than it. Each step of the descent picks a
+ * son by adding the result of the comparison to its index, and the bound is
+ * then the last position the descent went left from, which is found by
+ * dropping the trailing ones in the final index, and one more bit.
+ *
+ * @param frozen Frozen tree to search into.
+ * @param key Key to look for.
+ * @param strict 1 to look for a strictly greater key, 0 otherwise.
+ * @return Position of the key, 0 if there's none.
+ */
+ulong _spl_frozen_bound(SplayFrozen *frozen, SPL_KEY key, int strict) {
+    SPL_KEY *keys = frozen->_keys;
+    ulong n = frozen->nodes_count;
+    ulong pos = 1;
+    while (pos <= n) {
+#ifdef SPLAY_ENABLE_PREFETCH
+        // Sons some levels down are all in the same cache line.
+        __builtin_prefetch(keys + pos * SPL_FROZEN_LINE_KEYS);
+#endif
+        pos = 2 * pos + (SPL_KEY_CMP(keys[pos], key) < strict);
+    }
+    return pos >> __builtin_ffsl((long)~pos);
+}
+
+/**
+ * Returns the position that follows a given one in key order in a frozen tree
+ * of a given size.
+ *
+ * @param n Number of entries in the frozen tree.
+ * @param pos Position to start from, 0 to get the first one.
+ * @return Next position, 0 if there's none.
+ */
+ulong _spl_frozen_next(ulong n, ulong pos) {
+    if ((pos != 0) && (2 * pos + 1 > n)) {
+        // No right son: climb back from right sons, then once more.
+        while (pos & 1) pos >>= 1;
+        return pos >> 1;
+    }
+    // Go to the right son (or the root), then all the way down to the left.
+    pos = (pos == 0) ? 1 : 2 * pos + 1;
+    if (pos > n) return 0;
+    while (2 * pos <= n) pos *= 2;
+    return pos;
+}
+
+/**
+ * Returns the position that precedes a given one in key order in a frozen
+ * tree of a given size.
+ *
+ * @param n Number of entries in the frozen tree.
+ * @param pos Position to start from, 0 to get the last one.
+ * @return Previous position, 0 if there's none.
+ */
+ulong _spl_frozen_prev(ulong n, ulong pos) {
+    if ((pos != 0) && (2 * pos > n)) {
+        // No left son: climb back from left sons, then once more.
+        while ((pos & 1) == 0) pos >>= 1;
+        return pos >> 1;
+    }
+    // Go to the left son (or the root), then all the way down to the right.
+    pos = (pos == 0) ? 1 : 2 * pos;
+    if (pos > n) return 0;
+    while (2 * pos + 1 <= n) pos = 2 * pos + 1;
+    return pos;
+}
+
+/**
+ * Measures the memory taken by a tree and its nodes (see header).
+ *
+ * @param tree Pointer to the tree to look into.
+ * @param shape Pointer to the shape to store the measures into.
+ */
+void _spl_shape_memory(SplayTree *tree, SplayShape *shape) {
+    SplayPool *pool = tree->_pool;
+    shape->tree_bytes = sizeof(SplayTree);
+    if (pool == NULL) {
+        shape->tree_bytes += tree->nodes_count * sizeof(SplayNode);
+        return;
+    }
+    if (pool->_shared) pthread_mutex_lock(&(pool->_lock));
+    ulong bytes = sizeof(SplayPool);
+    ulong unused = 0;
+    for (SplayChunk *chunk = pool->_chunks; chunk != NULL;
+         chunk = chunk->_next) bytes += SPL_CHUNK_SIZE(chunk->_capacity);
+    // Nodes are carved from the current chunk, and those after it are new.
+    if (pool->_curr_chunk != NULL) {
+        unused = pool->_curr_chunk->_capacity - pool->_curr_used;
+        for (SplayChunk *chunk = pool->_curr_chunk->_next; chunk != NULL;
+             chunk = chunk->_next) unused += chunk->_capacity;
+    }
+    for (SplayNode *node = pool->_free_list; node != NULL;
+         node = node->_right_son) unused++;
+    if (pool->_shared) pthread_mutex_unlock(&(pool->_lock));
+    shape->tree_bytes += bytes;
+    shape->pool_slack_bytes = unused * sizeof(SplayNode);
+}
+
+/**
+ * Measures the shape of a tree exactly, walking it in pre-order through the
+ * "father" pointers while keeping track of the depth.
+ *
+ * @param root Root of the tree to walk.
+ * @param shape Pointer to the shape to store the measures into.
+ */
+void _spl_shape_walk(SplayNode *root, SplayShape *shape) {
+    SplayNode *curr = root;
+    ulong depth = 0, depth_total = 0, count = 0;
+    while (1) {
+        count++;
+        depth_total += depth;
+        if (depth > shape->height) shape->height = depth;
+        shape->depth_hist[(depth < SPLAY_SHAPE_DEPTHS) ?
+                          depth : SPLAY_SHAPE_DEPTHS - 1]++;
+        // Go down to the first son there is.
+        if ((curr->_left_son != NULL) || (curr->_right_son != NULL)) {
+            curr = (curr->_left_son != NULL) ? curr->_left_son :
+                                               curr->_right_son;
+            depth++;
+            continue;
+        }
+        // Climb back until there's a right son not visited yet.
+        while (1) {
+            if (curr == root) {
+                shape->avg_depth = (double)depth_total / (double)count;
+                return;
+            }
+            if ((curr->_father->_left_son == curr) &&
+                (curr->_father->_right_son != NULL)) {
+                curr = curr->_father->_right_son;
+                break;
+            }
+            curr = curr->_father;
+            depth--;
+        }
+    }
+}
+
+/**
+ * Estimates the shape of a tree from random descents from its root to a leaf,
+ * going to either son with the same probability (see header).
+ * Random choices are made with a xorshift generator, seeded from the tree.
+ *
+ * @param root Root of the tree to probe.
+ * @param shape Pointer to the shape to store the measures into.
+ * @param samples Number of descents.
+ */
+void _spl_shape_probe(SplayNode *root, SplayShape *shape, ulong samples) {
+    double counts[SPLAY_SHAPE_DEPTHS] = {0};
+    double nodes_total = 0.0, depth_total = 0.0, weight;
+    unsigned long long state = (unsigned long long)(uintptr_t)root | 1ULL;
+    SplayNode *curr;
+    ulong depth;
+    for (ulong i = 0; i < samples; i++) {
+        curr = root;
+        depth = 0;
+        weight = 1.0;
+        while (1) {
+            // Nodes reached with probability p stand for 1 / p nodes.
+            counts[(depth < SPLAY_SHAPE_DEPTHS) ?
+                   depth : SPLAY_SHAPE_DEPTHS - 1] += weight;
+            nodes_total += weight;
+            depth_total += weight * (double)depth;
+            if (depth > shape->height) shape->height = depth;
+            if ((curr->_left_son != NULL) && (curr->_right_son != NULL)) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                curr = (state & 1) ? curr->_right_son : curr->_left_son;
+                weight *= 2.0;
+            } else if (curr->_left_son != NULL) {
+                curr = curr->_left_son;
+            } else if (curr->_right_son != NULL) {
+                curr = curr->_right_son;
+            } else break;
+            depth++;
+        }
+    }
+    for (int i = 0; i < SPLAY_SHAPE_DEPTHS; i++)
+        shape->depth_hist[i] = (ulong)(counts[i] / (double)samples + 0.5);
+    shape->avg_depth = depth_total / nodes_total;
+    shape->sampled = 1;
+}
+
+/**
+ * Writes a whole buffer to a file, resuming after partial writes and
+ * interruptions.
+ *
+ * @param fd Descriptor of the file to write to.
+ * @param buf Pointer to the buffer to write.
+ * @param size Size of the buffer.
+ * @return 0 if all went well, -1 if writing failed.
+ */
+int _spl_write_all(int fd, const void *buf, size_t size) {
+    const char *curr = (const char *)buf;
+    while (size > 0) {
+        ssize_t written = write(fd, curr, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        curr += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * Fills a whole buffer from a file, resuming after partial reads and
+ * interruptions.
+ *
+ * @param fd Descriptor of the file to read from.
+ * @param buf Pointer to the buffer to fill.
+ * @param size Size of the buffer.
+ * @return 0 if all went well, -1 if reading failed or the file ended first.
+ */
+int _spl_read_all(int fd, void *buf, size_t size) {
+    char *curr = (char *)buf;
+    while (size > 0) {
+        ssize_t got = read(fd, curr, size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (got == 0) return -1;  // The file is truncated.
+        curr += got;
+        size -= (size_t)got;
+    }
+    return 0;
+}
+
+#ifdef SPL_KEY_PLAIN
+/**
+ * Links a range of the nodes of a snapshot, laid out by increasing keys, as a
+ * perfectly balanced subtree.
+ *
+ * @param nodes Pointer to the nodes array.
+ * @param first Index of the first node in the range, at least 1.
+ * @param last Index of the last node in the range.
+ * @return Index of the root of the new subtree, 0 if the range is empty.
+ */
+unsigned int _spl_snapshot_link(SplayCompactNode *nodes, ulong first,
+                                ulong last) {
+    if (first > last) return 0;
+    ulong mid = first + (last - first) / 2;
+    nodes[mid]._left_son = _spl_snapshot_link(nodes, first, mid - 1);
+    nodes[mid]._right_son = _spl_snapshot_link(nodes, mid + 1, last);
+    return (unsigned int)mid;
+}
+
+/**
+ * Links the nodes of a snapshot and writes it to a file.
+ *
+ * @param fd Descriptor of the file to write to.
+ * @param nodes Pointer to the nodes array, with keys by increasing order from
+ *              index 1 on and index 0 zeroed.
+ * @param data Pointer to the data array, laid out as the nodes.
+ * @param n Number of nodes.
+ * @return 0 if all went well, -1 if writing failed.
+ */
+int _spl_snapshot_write(int fd, SplayCompactNode *nodes, void **data,
+                        ulong n) {
+    static const char padding[sizeof(void *)] = {0};
+    SplaySnapshot header;
+    header.magic = SPL_SNAPSHOT_MAGIC;
+    header.node_size = sizeof(SplayCompactNode);
+    header.data_size = sizeof(void *);
+    header.root = _spl_snapshot_link(nodes, 1, n);
+    header.nodes_count = n;
+    size_t nodes_size = (n + 1) * sizeof(SplayCompactNode);
+    if ((_spl_write_all(fd, &header, sizeof(SplaySnapshot)) != 0) ||
+        (_spl_write_all(fd, nodes, nodes_size) != 0) ||
+        (_spl_write_all(fd, padding, SPL_SNAPSHOT_DATA_OFFSET(n) -
+                        sizeof(SplaySnapshot) - nodes_size) != 0) ||
+        (_spl_write_all(fd, data, (n + 1) * sizeof(void *)) != 0))
+        return -1;
+    return 0;
+}
+
+/**
+ * Reads a snapshot from a file into new arrays, checking its header.
+ * Links are rebuilt rather than read, so that the nodes always make up a
+ * valid tree.
+ *
+ * @param fd Descriptor of the file to read from.
+ * @param header Pointer to the location to read the header into.
+ * @param nodes Pointer to the location to return the nodes array into.
+ * @param data Pointer to the location to return the data array into.
+ * @return 0 if all went well, -1 if reading or allocation failed or the
+ *         snapshot is not valid.
+ */
+int _spl_snapshot_read(int fd, SplaySnapshot *header,
+                       SplayCompactNode **nodes, void ***data) {
+    if ((fd < 0) || (_spl_read_all(fd, header, sizeof(SplaySnapshot)) != 0) ||
+        (header->magic != SPL_SNAPSHOT_MAGIC) ||
+        (header->node_size != sizeof(SplayCompactNode)) ||
+        (header->data_size != sizeof(void *)) ||
+        (header->nodes_count >= SPL_COMPACT_MAX_CAPACITY)) return -1;
+    ulong n = header->nodes_count;
+    size_t nodes_size = (n + 1) * sizeof(SplayCompactNode);
+    char padding[sizeof(void *)];
+    *nodes = (SplayCompactNode *)malloc(nodes_size);
+    *data = (void **)malloc((n + 1) * sizeof(void *));
+    if ((*nodes == NULL) || (*data == NULL) ||
+        (_spl_read_all(fd, *nodes, nodes_size) != 0) ||
+        (_spl_read_all(fd, padding, SPL_SNAPSHOT_DATA_OFFSET(n) -
+                       sizeof(SplaySnapshot) - nodes_size) != 0) ||
+        (_spl_read_all(fd, *data, (n + 1) * sizeof(void *)) != 0)) {
+        free(*nodes);
+        free(*data);
+        return -1;
+    }
+    header->root = _spl_snapshot_link(*nodes, 1, n);
+    (*nodes)[0]._left_son = 0;
+    (*nodes)[0]._right_son = 0;
+    return 0;
+}
+#endif
+
+#ifdef SPLAY_ENABLE_ORDER_STATS
+/**
+ * Recomputes the subtree sizes of a node and of all of its ancestors, from
+ * the node up. Sizes of the other sons along the path must be correct.
+ *
+ * @param node Lowest node to fix.
+ */
+void _spl_size_fix_path(SplayNode *node) {
+    while (node != NULL) {
+        SPL_SIZE_FIX(node);
+        node = node->_father;
+    }
+}
+
+/**
+ * Recomputes the subtree sizes of all nodes in a subtree with a post-order
+ * walk, which takes linear time and no memory.
+ *
+ * @param root Root of the subtree to fix.
+ */
+void _spl_size_fix_all(SplayNode *root) {
+    SplayNode *curr = root, *prev = root->_father;
+    SplayNode *node;
+    while ((node = _spl_dfs_next(root, &curr, &prev, DFS_POST_ORDER)) != NULL)
+        SPL_SIZE_FIX(node);
+}
+#endif
@@ -0,0 +1,452 @@
+/**
+ * @brief Splay Tree data structure library template header.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file contains type definitions and declarations for the Splay Tree data
+ * structure, written once for all flavours of the library (i.e. types of
+ * keys). Each flavour's header defines the following parameters, then includes
+ * splay-trees_names.h, this file and splay-trees_undef.h, so that the generic
+ * names used here (e.g. SplayTree, splay_search) become its own:
+ * - SPL_TYPE_PREFIX: prefix of type names (e.g. SplayInt).
+ * - SPL_FUNC_PREFIX: prefix of function names (e.g. splay_int).
+ * - SPL_INTERNAL_PREFIX: prefix of internal subroutines' names (e.g. _spli).
+ * - SPL_KEY: type of the keys stored in nodes.
+ * - SPL_KEY_ARG: type of the keys passed to and returned by functions, at
+ *   most as wide as a pointer; it can differ from SPL_KEY, e.g. if nodes cache
+ *   something more about their keys.
+ * - SPL_KEY_PLAIN: defined if keys are plain values, which can be copied byte
+ *   by byte, e.g. to save trees to files (see below).
+ * Hence, this file has no include guard on purpose, and must not be included
+ * directly. See the template source file for brief descriptions of what each
+ * function does.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+/**
+ * A Splay Tree's node stores pointers to its "father" node and to its sons.
+ * Since we're using the "splay" heuristic, no balance information is stored.
+ * Keys are of the type chosen by the flavour of the library (see its header).
+ * The data kept inside the node can be everything, as long as it's at most
+ * sizeof(void *)-wide. Could be e.g. pointers.
+ * Note that, as per the deletion options, is not possible to have only SOME
+ * data in the heap: either all or none, so think about the data you're
+ * providing to these functions.
+ * If the library is compiled with SPLAY_ENABLE_ORDER_STATS defined, each node
+ * also stores the number of nodes in its subtree, kept up to date by all
+ * operations, so that entries can be looked up by their position in key
+ * order (see splay_select and splay_rank) in logarithmic amortized time.
+ * Otherwise nodes aren't any larger and rotations don't spend anything on it.
+ * Since this changes the layout of nodes, the same setting must be used to
+ * compile both the library and the code that uses it.
+ */
+typedef struct _splay_node {
+    struct _splay_node *_father;
+    struct _splay_node *_left_son;
+    struct _splay_node *_right_son;
+    SPL_KEY _key;
+    void *_data;
+#ifdef SPLAY_ENABLE_ORDER_STATS
+    unsigned long int _size;
+#endif
+} SplayNode;
+
+/**
+ * Nodes can be allocated from a pool attached to a tree upon its creation,
+ * instead of calling malloc and free for each one of them.
+ * A pool carves nodes out of big, cache-line-aligned slabs ("chunks") in which
+ * they are packed one after the other, and keeps released nodes in a free list
+ * (linked through their right son pointers) ready to be reused. Chunks are
+ * only released all at once together with the tree.
+ * Trees obtained by splitting a pooled tree share its pool, which keeps track
+ * of how many trees are using it and, from then on, serializes allocations
+ * with an internal lock, so that the trees can be handed to different threads.
+ * A pool is requested to create_splay_tree_ex with a configuration
+ * specifying how many nodes each chunk must hold (0 picks a default value).
+ */
+typedef struct {
+    unsigned long int nodes_per_chunk;
+} SplayPoolConfig;
+
+typedef struct _splay_chunk {
+    struct _splay_chunk *_next;
+    unsigned long int _capacity;
+} SplayChunk;
+
+typedef struct {
+    SplayChunk *_chunks;
+    SplayChunk *_curr_chunk;
+    unsigned long int _curr_used;
+    SplayNode *_free_list;
+    unsigned long int _nodes_per_chunk;
+    unsigned long int _refs;
+    int _shared;
+    pthread_mutex_t _lock;
+} SplayPool;
+
+/**
+ * If the library is compiled with SPLAY_ENABLE_STATS defined, each tree keeps
+ * the following counters, which can be read with splay_stats:
+ * - searches: searches performed, split in hits and misses.
+ * - descents: descents from the root looking for a key, made by searches,
+ *   insertions and deletions, which reached nodes at depth_total overall
+ *   depth and depth_max at most.
+ * - splays: splaying operations, which took splay_steps steps (i.e. zig,
+ *   zig-zig or zig-zag at once) overall and rotations single rotations.
+ * - allocations and frees: nodes created and released.
+ * Counters are updated with relaxed atomic operations, so they stay correct
+ * when searches run concurrently, and are never reset.
+ * Otherwise, no counter is kept and nothing is spent on them.
+ * Since this changes the layout of trees, the same setting must be used to
+ * compile both the library and the code that uses it.
+ */
+typedef struct {
+    unsigned long int searches;
+    unsigned long int hits;
+    unsigned long int misses;
+    unsigned long int descents;
+    unsigned long int depth_total;
+    unsigned long int depth_max;
+    unsigned long int splays;
+    unsigned long int splay_steps;
+    unsigned long int rotations;
+    unsigned long int allocations;
+    unsigned long int frees;
+} SplayStats;
+
+/**
+ * The shape of a tree and the memory it takes can be measured at any time
+ * with splay_shape_stats, which reports:
+ * - nodes: nodes in the tree.
+ * - height and avg_depth: depth of the deepest node and average depth of all
+ *   nodes, the root being at depth 0.
+ * - depth_hist: how many nodes are found at each depth.
+ * - tree_bytes: memory taken by the tree and its nodes, or by its pool if it
+ *   has one (even if shared), of which pool_slack_bytes hold no node.
+ * - data_bytes: memory taken by the data of all entries, if the size of each
+ *   one is given.
+ * Shapes can be measured exactly, walking the whole tree, or estimated from
+ * a number of random descents from the root to a leaf: then, sampled is set,
+ * height is that of the deepest leaf reached, and nodes at each depth are
+ * estimated as Knuth did for search trees, i.e. each node reached counts as
+ * many nodes as one over the probability of reaching it.
+ */
+typedef struct {
+    unsigned long int nodes;
+    unsigned long int height;
+    double avg_depth;
+    unsigned long int depth_hist[SPLAY_SHAPE_DEPTHS];
+    unsigned long int tree_bytes;
+    unsigned long int pool_slack_bytes;
+    unsigned long int data_bytes;
+    int sampled;
+} SplayShape;
+
+/**
+ * Callbacks can be passed to functions that visit many nodes, which will call
+ * them on the key and data of each one, passing along an opaque context
+ * pointer provided by the caller. Returning a non-zero value stops the visit.
+ * Callbacks must not modify the tree they're called on.
+ */
+typedef int (*SplayCallback)(SPL_KEY_ARG key, void *data, void *ctx);
+
+/**
+ * A Splay Tree stores a pointer to its root node and a counter which keeps
+ * track of the number of nodes in the structure, to get an idea of its "size"
+ * and be able to efficiently perform searches.
+ * Splay trees implemented like this have a size limit set by the maximum
+ * amount representable with an unsigned long integer, automatically set (as
+ * long as you compile this code on the same machine you're going to use it on).
+ * The splaying strategy can be changed at any time through splay_opts and
+ * splay_depth (see above), which are empty by default.
+ * If the tree has no node pool, its nodes are allocated one by one in the heap.
+ * The tree also remembers the last node found by a finger search (see
+ * splay_finger_search), from which the next one will start, and which is
+ * splayed bottom-up if requested; other operations only forget it when it's
+ * deleted.
+ * With SPLAY_EVICT in splay_opts, the tree works as a bounded cache: entries
+ * it evicts are passed to evict_callback, if any, together with evict_ctx, so
+ * that their keys and data can be freed (what the callback returns is
+ * ignored).
+ * Searches given SEARCH_REBALANCE compare their depth with rebalance_factor,
+ * which is 2 by default (0 means never to rebalance).
+ */
+typedef struct {
+    SplayNode *_root;
+    SplayNode *_finger;
+    SplayPool *_pool;
+    unsigned long int nodes_count;
+    unsigned long int max_nodes;
+    int splay_opts;
+    unsigned long int splay_depth;
+    unsigned int rebalance_factor;
+    SplayCallback evict_callback;
+    void *evict_ctx;
+#ifdef SPLAY_ENABLE_STATS
+    SplayStats _stats;
+#endif
+} SplayTree;
+
+/**
+ * An iterator walks a tree in order, starting from its least (or greatest)
+ * key, without splaying and without any memory allocation. Since it climbs
+ * back using the "father" pointers, it only stores the node it's at.
+ * The tree must not be modified while iterators are operating on it, but many
+ * of them can run concurrently with non-splaying searches.
+ */
+typedef struct {
+    SplayNode *_curr;
+    int _opts;
+} SplayIter;
+
+/**
+ * A walk token keeps the position of a DFS or BFS that fills a buffer
+ * provided by the caller, so that it can go on from there in the next call,
+ * filling buffers one chunk at a time. Tokens must be zeroed before the first
+ * call, and only hold the node the walk is at and, for BFSs, where the
+ * current and next levels end, so walks do no allocation at all. The tree
+ * must not be modified until the walk is over.
+ */
+typedef struct {
+    SplayNode *_curr;
+    SplayNode *_prev;
+    SplayNode *_level_last;
+    SplayNode *_next_first;
+    SplayNode *_next_last;
+    ulong _depth;
+    int _state;
+} SplayWalk;
+
+/**
+ * A concurrent Splay Tree wraps a tree with a readers-writer lock, so that it
+ * can be safely accessed by many threads. Insertions and deletions take the
+ * lock exclusively, while searches that don't splay can run in parallel.
+ * Searches that should splay (i.e. with SEARCH_SPLAY) are performed as
+ * non-splaying ones too, but record the searched key in an access log private
+ * to the calling thread; the next operation that takes the lock exclusively,
+ * or a maintenance call, splays all logged keys in a batch. This keeps the
+ * cache-like behaviour of splaying without making searches exclusive.
+ * Each log keeps only the most recent SPLAY_SYNC_LOG_SIZE keys.
+ */
+typedef struct _splay_access_log {
+    struct _splay_access_log *_next;
+    struct _splay_access_log **_prev_next;
+    struct _splay_sync_tree *_owner;
+    unsigned long int _count;
+    SPL_KEY _keys[SPLAY_SYNC_LOG_SIZE];
+} SplayAccessLog;
+
+typedef struct _splay_sync_tree {
+    SplayTree *_tree;
+    pthread_rwlock_t _lock;
+    pthread_mutex_t _logs_lock;
+    pthread_key_t _log_key;
+    SplayAccessLog *_logs;
+} SplaySyncTree;
+
+/**
+ * A sharded Splay Tree partitions keys among many concurrent trees (shards),
+ * each one with its own lock, so that threads working on different shards
+ * never contend. Keys are assigned to shards by range or by hash, as chosen
+ * upon its creation (see splay-trees_common.h).
+ */
+typedef struct {
+    SplaySyncTree **_shards;
+    SPL_KEY *_bounds;
+    unsigned int _shards_count;
+    int _mode;
+} SplayShardTree;
+
+/**
+ * A sharded iterator walks a sharded tree in key order, holding the locks of
+ * the shards it's walking for reading (only the current one by range, all of
+ * them by hash) until it's terminated, so it must always be terminated with
+ * splay_shard_iter_end, and the thread using it must not modify the same
+ * tree in the meantime.
+ */
+typedef struct {
+    SplayShardTree *_shtree;
+    SplayIter _iter;
+    SplayIter *_iters;
+    unsigned int _shard;
+    int _opts;
+} SplayShardIter;
+
+/**
+ * A compact Splay Tree keeps all of its nodes in a single array, which grows
+ * as needed, and links them with 32-bit indices instead of pointers. Since it
+ * is always splayed top-down, nodes don't link to their fathers, so each one
+ * takes 8 bytes plus its key (12 bytes with int keys), plus 8 for its data
+ * which is kept in a parallel array.
+ * Index 0 stands for no node, so up to 2^32 - 2 nodes can be stored.
+ * Released nodes are kept in a free list, linked through their right sons.
+ * Since arrays can be moved when they grow, nodes can't be returned by
+ * searches (i.e. SEARCH_NODES is not supported).
+ */
+typedef struct {
+    unsigned int _left_son;
+    unsigned int _right_son;
+    SPL_KEY _key;
+} SplayCompactNode;
+
+typedef struct {
+    SplayCompactNode *_nodes;
+    void **_data;
+    unsigned int _root;
+    unsigned int _free_list;
+    unsigned int _used;
+    unsigned int _capacity;
+    unsigned long int nodes_count;
+    unsigned long int max_nodes;
+    void *_map;
+    unsigned long int _map_size;
+} SplayCompactTree;
+
+/**
+ * A frozen Splay Tree is a read-only copy of a tree, laid out to be searched
+ * as fast as possible: keys are packed in an array in Eytzinger order (i.e.
+ * that of a BFS of a perfectly balanced tree, starting from 1), so that the
+ * first levels of all descents share the same few cache lines, sons are found
+ * with arithmetic and descents don't branch. Data is kept in a parallel array.
+ * Since it's never modified, any number of threads can search it without
+ * locking, while the tree it was made from goes on changing.
+ * Keys and data are shared with the tree, not copied.
+ */
+typedef struct {
+    SPL_KEY *_keys;
+    void **_data;
+    unsigned long int nodes_count;
+} SplayFrozen;
+
+#ifdef SPL_KEY_PLAIN
+/**
+ * Trees can be saved to files as snapshots, which can then be loaded into
+ * trees again without comparing keys nor splaying, or mapped in memory as
+ * read-only compact trees without copying nor reading anything in advance.
+ * A snapshot holds the nodes of a perfectly balanced compact tree, laid out
+ * by increasing keys from index 1 on, followed by their data (at an offset
+ * aligned to pointers) and preceded by this header.
+ * Data is saved as it is, so only data that isn't a pointer (e.g. integers)
+ * is meaningful once loaded. Snapshots can only be read on machines with the
+ * same data model and byte order of the one that wrote them, which is
+ * checked through the header.
+ * Mapped trees can only be searched without splaying, and deleted: all other
+ * operations that would modify them fail.
+ */
+typedef struct {
+    unsigned int magic;
+    unsigned int node_size;
+    unsigned int data_size;
+    unsigned int root;
+    unsigned long int nodes_count;
+} SplaySnapshot;
+#endif
+
+/* Library functions. */
+SplayTree *create_splay_tree(void);
+SplayTree *create_splay_tree_ex(const SplayPoolConfig *pool_cfg);
+int delete_splay_tree(SplayTree *tree, int opts);
+int splay_clear(SplayTree *tree, int opts);
+void *splay_search(SplayTree *tree, SPL_KEY_ARG key, int opts);
+void *splay_finger_search(SplayTree *tree, SPL_KEY_ARG key, int opts);
+ulong splay_insert(SplayTree *tree, SPL_KEY_ARG new_key, void *new_data);
+int splay_upsert(SplayTree *tree, SPL_KEY_ARG key, void *data,
+                 void **old_data);
+SplayNode *splay_get_or_insert(SplayTree *tree, SPL_KEY_ARG key, void *data,
+                               int *inserted);
+ulong splay_search_batch(SplayTree *tree, SPL_KEY_ARG const *keys, ulong n,
+                         void **out, int opts);
+ulong splay_insert_batch(SplayTree *tree, SPL_KEY_ARG const *keys,
+                         void **data, ulong n);
+void *splay_floor(SplayTree *tree, SPL_KEY_ARG key, int opts);
+void *splay_ceiling(SplayTree *tree, SPL_KEY_ARG key, int opts);
+void *splay_predecessor(SplayTree *tree, SPL_KEY_ARG key, int opts);
+void *splay_successor(SplayTree *tree, SPL_KEY_ARG key, int opts);
+void *splay_min(SplayTree *tree, int opts);
+void *splay_max(SplayTree *tree, int opts);
+void *splay_select(SplayTree *tree, ulong pos, int opts);
+int splay_rank(SplayTree *tree, SPL_KEY_ARG key, ulong *rank, int opts);
+int splay_delete(SplayTree *tree, SPL_KEY_ARG key, int opts);
+ulong splay_delete_range(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                         int opts);
+void **splay_dfs(SplayTree *tree, int type, int opts);
+void **splay_bfs(SplayTree *tree, int type, int opts);
+ulong splay_dfs_buf(SplayTree *tree, int type, int opts, void *buf,
+                    ulong capacity, SplayWalk *walk);
+ulong splay_bfs_buf(SplayTree *tree, int type, int opts, void *buf,
+                    ulong capacity, SplayWalk *walk);
+SplayTree *splay_build_sorted(SPL_KEY_ARG const *keys, void **data,
+                             ulong n);
+SplayNode *splay_iter_begin(SplayTree *tree, SplayIter *iter,
+                            int opts);
+SplayNode *splay_iter_next(SplayIter *iter);
+void splay_iter_end(SplayIter *iter);
+ulong splay_range(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                  SplayCallback callback, void *ctx, int opts);
+ulong splay_range_count(SplayTree *tree, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                        int opts);
+int splay_split(SplayTree *tree, SPL_KEY_ARG key,
+                SplayTree **left, SplayTree **right);
+SplayTree *splay_join(SplayTree *left, SplayTree *right);
+int splay_rebalance(SplayTree *tree);
+SplayTree *splay_merge(SplayTree *dst, SplayTree *src, int opts);
+SplaySyncTree *create_splay_sync_tree(SplayTree *tree);
+int delete_splay_sync_tree(SplaySyncTree *stree, int opts);
+void *splay_sync_search(SplaySyncTree *stree, SPL_KEY_ARG key, int opts);
+ulong splay_sync_insert(SplaySyncTree *stree, SPL_KEY_ARG new_key,
+                        void *new_data);
+int splay_sync_delete(SplaySyncTree *stree, SPL_KEY_ARG key, int opts);
+void **splay_sync_dfs(SplaySyncTree *stree, int type, int opts);
+void **splay_sync_bfs(SplaySyncTree *stree, int type, int opts);
+void splay_sync_maintain(SplaySyncTree *stree);
+SplayShardTree *create_splay_shard_tree(
+    unsigned int shards_count, int mode, SPL_KEY_ARG const *bounds,
+    const SplayPoolConfig *pool_cfg);
+int delete_splay_shard_tree(SplayShardTree *shtree, int opts);
+void *splay_shard_search(SplayShardTree *shtree, SPL_KEY_ARG key, int opts);
+ulong splay_shard_insert(SplayShardTree *shtree, SPL_KEY_ARG new_key,
+                         void *new_data);
+int splay_shard_delete(SplayShardTree *shtree, SPL_KEY_ARG key, int opts);
+void **splay_shard_dfs(SplayShardTree *shtree, int type, int opts);
+ulong splay_shard_count(SplayShardTree *shtree);
+SplayNode *splay_shard_iter_begin(SplayShardTree *shtree,
+                                  SplayShardIter *iter, int opts);
+SplayNode *splay_shard_iter_from(SplayShardTree *shtree,
+                                 SplayShardIter *iter, SPL_KEY_ARG key,
+                                 int opts);
+SplayNode *splay_shard_iter_next(SplayShardIter *iter);
+void splay_shard_iter_end(SplayShardIter *iter);
+SplayCompactTree *create_splay_compact_tree(ulong capacity);
+int delete_splay_compact_tree(SplayCompactTree *ctree, int opts);
+void *splay_compact_search(SplayCompactTree *ctree, SPL_KEY_ARG key, int opts);
+ulong splay_compact_insert(SplayCompactTree *ctree, SPL_KEY_ARG new_key,
+                           void *new_data);
+int splay_compact_delete(SplayCompactTree *ctree, SPL_KEY_ARG key, int opts);
+void **splay_compact_dfs(SplayCompactTree *ctree, int type, int opts);
+SplayFrozen *splay_freeze(SplayTree *tree);
+int delete_splay_frozen(SplayFrozen *frozen);
+void *splay_frozen_search(SplayFrozen *frozen, SPL_KEY_ARG key, int opts);
+int splay_frozen_floor(SplayFrozen *frozen, SPL_KEY_ARG key,
+                       SPL_KEY_ARG *found_key, void **found_data);
+int splay_frozen_ceiling(SplayFrozen *frozen, SPL_KEY_ARG key,
+                         SPL_KEY_ARG *found_key, void **found_data);
+ulong splay_frozen_range(SplayFrozen *frozen, SPL_KEY_ARG lo, SPL_KEY_ARG hi,
+                         SplayCallback callback, void *ctx);
+#ifdef SPL_KEY_PLAIN
+int splay_save(SplayTree *tree, int fd);
+SplayTree *splay_load(int fd);
+int splay_compact_save(SplayCompactTree *ctree, int fd);
+SplayCompactTree *splay_compact_load(int fd);
+SplayCompactTree *splay_compact_map(int fd);
+#endif
+int splay_stats(SplayTree *tree, SplayStats *stats);
+int splay_sync_stats(SplaySyncTree *stree, SplayStats *stats);
+int splay_shard_stats(SplayShardTree *shtree, SplayStats *stats);
+int splay_shape_stats(SplayTree *tree, SplayShape *shape, ulong data_size,
+                      ulong samples);
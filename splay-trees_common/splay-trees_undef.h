@@ -0,0 +1,212 @@
+/**
+ * @brief Splay Tree data structure library template names cleanup.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file undefines the generic names and the parameters of a flavour
+ * once its header has been processed, so that many flavours can be used in
+ * the same translation unit. It's meant to be included only by flavours'
+ * headers, and has no include guard on purpose.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+/* Types. */
+#undef SplayNode
+#undef SplayTree
+#undef SplayChunk
+#undef SplayPool
+#undef SplaySyncTree
+#undef SplayShardTree
+#undef SplayShardIter
+#undef SplayCompactTree
+#undef SplayCompactNode
+#undef SplayStats
+#undef SplayPoolConfig
+#undef SplayIter
+#undef SplayCallback
+#undef SplayAccessLog
+
+#undef SplaySnapshot
+#undef SplayWalk
+#undef SplayFrozen
+#undef SplayShape
+/* Structure tags. */
+#undef _splay_node
+#undef _splay_chunk
+#undef _splay_access_log
+#undef _splay_sync_tree
+
+/* Library functions. */
+#undef create_splay_tree
+#undef create_splay_tree_ex
+#undef create_splay_sync_tree
+#undef create_splay_shard_tree
+#undef create_splay_compact_tree
+#undef delete_splay_tree
+#undef delete_splay_sync_tree
+#undef delete_splay_shard_tree
+#undef delete_splay_compact_tree
+#undef splay_bfs
+#undef splay_search
+#undef splay_delete
+#undef splay_insert
+#undef splay_dfs
+#undef splay_build_sorted
+#undef splay_iter_begin
+#undef splay_iter_next
+#undef splay_iter_end
+#undef splay_range
+#undef splay_range_count
+#undef splay_split
+#undef splay_join
+#undef splay_sync_search
+#undef splay_sync_insert
+#undef splay_sync_delete
+#undef splay_sync_dfs
+#undef splay_sync_bfs
+#undef splay_sync_maintain
+#undef splay_shard_search
+#undef splay_shard_count
+#undef splay_shard_insert
+#undef splay_shard_delete
+#undef splay_shard_dfs
+#undef splay_shard_iter_begin
+#undef splay_shard_iter_from
+#undef splay_shard_iter_next
+#undef splay_shard_iter_end
+#undef splay_compact_search
+#undef splay_compact_insert
+#undef splay_compact_delete
+#undef splay_compact_dfs
+#undef splay_stats
+#undef splay_sync_stats
+#undef splay_shard_stats
+
+#undef splay_save
+#undef splay_load
+#undef splay_compact_save
+#undef splay_compact_load
+#undef splay_compact_map
+#undef splay_clear
+#undef splay_floor
+#undef splay_ceiling
+#undef splay_predecessor
+#undef splay_successor
+#undef splay_min
+#undef splay_max
+#undef splay_select
+#undef splay_rank
+#undef splay_finger_search
+#undef splay_search_batch
+#undef splay_insert_batch
+#undef splay_upsert
+#undef splay_get_or_insert
+#undef splay_dfs_buf
+#undef splay_bfs_buf
+#undef splay_rebalance
+#undef splay_merge
+#undef splay_freeze
+#undef delete_splay_frozen
+#undef splay_frozen_search
+#undef splay_frozen_floor
+#undef splay_frozen_ceiling
+#undef splay_frozen_range
+#undef splay_delete_range
+#undef splay_shape_stats
+/* Internal library subroutines. */
+#undef _spl_stat_max
+#undef _spl_create_node
+#undef _spl_delete_node
+#undef _spl_pool_add_chunk
+#undef _spl_pool_alloc
+#undef _spl_pool_free
+#undef _spl_pool_share
+#undef _spl_pool_absorb
+#undef _spl_pool_release
+#undef _spl_pool_is_shared
+#undef _spl_build_balanced
+#undef _spl_search_node
+#undef _spl_lower_bound
+#undef _spl_floor_bound
+#undef _spl_insert_left_subtree
+#undef _spl_insert_right_subtree
+#undef _spl_cut_left_subtree
+#undef _spl_cut_right_subtree
+#undef _spl_max_key_son
+#undef _spl_min_key_son
+#undef _spl_successor
+#undef _spl_predecessor
+#undef _spl_right_rotation
+#undef _spl_left_rotation
+#undef _spl_splay
+#undef _spl_splay_node
+#undef _spl_splay_subtree
+#undef _spl_semi_splay_node
+#undef _spl_join
+#undef _spl_td_splay
+#undef _spl_td_splay_max
+#undef _spl_td_splay_min
+#undef _spl_splay_max
+#undef _spl_splay_min
+#undef _spl_splay_floor
+#undef _spl_count_left
+#undef _spl_sync_log_access
+#undef _spl_sync_log_destroy
+#undef _spl_sync_apply_logs
+#undef _spl_td_join
+#undef _spl_dfs_next
+#undef _spl_store_node
+#undef _spl_dfs_fill
+#undef _spl_shard_index
+#undef _spl_shard_iter_walk
+#undef _spl_shard_iter_pick
+#undef _spl_compact_alloc
+#undef _spl_compact_grow
+#undef _spl_compact_splay
+#undef _spl_compact_splay_max
+#undef _spl_stats_merge
+
+#undef _spl_write_all
+#undef _spl_read_all
+#undef _spl_snapshot_link
+#undef _spl_snapshot_write
+#undef _spl_snapshot_read
+#undef _spl_free_nodes
+#undef _spl_nearest
+#undef _spl_nearest_result
+#undef _spl_splay_found
+#undef _spl_size_fix_path
+#undef _spl_size_fix_all
+#undef _spl_search_from
+#undef _spl_finger_climb
+#undef _spl_batch_order
+#undef _spl_batch_descend
+#undef _spl_insert_root
+#undef _spl_find_or_insert
+#undef _spl_walk_opts
+#undef _spl_level_first
+#undef _spl_level_next
+#undef _spl_evict
+#undef _spl_tree_to_vine
+#undef _spl_vine_compress
+#undef _spl_floor_log2
+#undef _spl_vine_to_tree
+#undef _spl_frozen_bound
+#undef _spl_frozen_next
+#undef _spl_frozen_prev
+#undef _spl_shape_memory
+#undef _spl_shape_walk
+#undef _spl_shape_probe
+/* Flavour parameters. */
+#undef SPL_TYPE_PREFIX
+#undef SPL_FUNC_PREFIX
+#undef SPL_INTERNAL_PREFIX
+#undef SPL_KEY
+#undef SPL_KEY_ARG
+#undef SPL_KEY_PLAIN
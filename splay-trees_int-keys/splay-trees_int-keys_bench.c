@@ -0,0 +1,542 @@
+/**
+ * @brief Splay Tree data structure library benchmark.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This program measures the performance of Splay Trees on a few synthetic
+ * workloads, comparing them with an AVL tree as a balanced baseline.
+ * The same sequence of operations is generated once for each workload and
+ * then run on:
+ * - A Splay Tree searched without splaying.
+ * - A Splay Tree searched with SEARCH_SPLAY.
+ * - An AVL tree.
+ * For each run this reports throughput and latency percentiles, and, if the
+ * library has been compiled with statistics counters enabled, the average
+ * depth reached by descents and the rotations done for each operation.
+ * Workloads are:
+ * - uniform: searches of keys picked uniformly at random.
+ * - zipf: searches of keys picked with a Zipfian distribution, so that a few
+ *   keys get most of the accesses.
+ * - sequential: searches of all keys in increasing order, over and over.
+ * - window: insertions of increasing keys, each one deleting the oldest one
+ *   in a sliding window, mixed with searches of recently inserted keys.
+ * - mixed: Zipfian accesses, each one either a search or (with the given
+ *   ratio) an update that deletes and reinserts the key.
+ * Build with e.g.:
+ *   gcc -O2 -DSPLAY_ENABLE_STATS splay-trees_int-keys_bench.c
+ *       splay-trees_int-keys.c -o splay-trees_int-keys_bench -pthread -lm
+ * and run it with -h to see all options.
+ * To measure the effects of a build option of the library, e.g. the
+ * prefetching descent, build it twice with and without the option (here,
+ * -DSPLAY_ENABLE_PREFETCH) and compare runs with the same parameters on a
+ * tree that doesn't fit in caches, e.g. "-w uniform -n 4000000".
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "splay-trees_int-keys.h"
+
+/* Operations a workload is made of. */
+#define BENCH_SEARCH 0
+#define BENCH_INSERT 1
+#define BENCH_DELETE 2
+
+typedef struct {
+    int type;
+    int key;
+} BenchOp;
+
+/* Benchmark parameters, set from the command line. */
+typedef struct {
+    const char *workload;
+    ulong keys;
+    ulong ops;
+    ulong window;
+    double theta;
+    double write_ratio;
+    unsigned int seed;
+    int pooled;
+} BenchConfig;
+
+/* AVL tree used as a baseline. */
+typedef struct _bench_avl_node {
+    struct _bench_avl_node *left;
+    struct _bench_avl_node *right;
+    int key;
+    int height;
+    void *data;
+} BenchAVLNode;
+
+/* A tree under test, with the operations to run on it. */
+typedef struct {
+    const char *name;
+    void *tree;
+    void *(*search)(void *tree, int key);
+    void (*insert)(void *tree, int key);
+    void (*remove)(void *tree, int key);
+} BenchTarget;
+
+/* Generators and helpers. */
+ulong bench_rand(ulong *state);
+double bench_rand_unit(ulong *state);
+void bench_shuffle(int *keys, ulong n, ulong *state);
+BenchOp *bench_generate(const BenchConfig *cfg, int **prefill,
+                        ulong *prefill_count);
+int bench_compare_ns(const void *a, const void *b);
+long long int bench_now_ns(void);
+/* Splay Tree targets. */
+void *bench_splay_search(void *tree, int key);
+void *bench_splay_search_splay(void *tree, int key);
+void bench_splay_insert(void *tree, int key);
+void bench_splay_remove(void *tree, int key);
+/* AVL tree targets. */
+int bench_avl_height(BenchAVLNode *node);
+BenchAVLNode *bench_avl_fix(BenchAVLNode *node);
+BenchAVLNode *bench_avl_rotate_right(BenchAVLNode *node);
+BenchAVLNode *bench_avl_rotate_left(BenchAVLNode *node);
+BenchAVLNode *bench_avl_balance(BenchAVLNode *node);
+BenchAVLNode *bench_avl_insert_node(BenchAVLNode *node, int key);
+BenchAVLNode *bench_avl_remove_node(BenchAVLNode *node, int key);
+BenchAVLNode *bench_avl_remove_min(BenchAVLNode *node, BenchAVLNode **min);
+void bench_avl_free(BenchAVLNode *node);
+void *bench_avl_search(void *tree, int key);
+void bench_avl_insert(void *tree, int key);
+void bench_avl_remove(void *tree, int key);
+/* Runner. */
+void bench_run(BenchTarget *target, const BenchOp *ops, ulong ops_count,
+               SplayIntTree *splay_tree);
+
+int main(int argc, char **argv) {
+    BenchConfig cfg = {"uniform", 1000000, 5000000, 100000, 0.99, 0.1, 42, 0};
+    int opt;
+    while ((opt = getopt(argc, argv, "w:n:o:W:t:u:s:ph")) != -1) {
+        switch (opt) {
+        case 'w': cfg.workload = optarg; break;
+        case 'n': cfg.keys = strtoul(optarg, NULL, 10); break;
+        case 'o': cfg.ops = strtoul(optarg, NULL, 10); break;
+        case 'W': cfg.window = strtoul(optarg, NULL, 10); break;
+        case 't': cfg.theta = strtod(optarg, NULL); break;
+        case 'u': cfg.write_ratio = strtod(optarg, NULL); break;
+        case 's': cfg.seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case 'p': cfg.pooled = 1; break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-w uniform|zipf|sequential|window|mixed|all] "
+                    "[-n keys] [-o ops] [-W window] [-t zipf_theta] "
+                    "[-u write_ratio] [-s seed] [-p (pooled nodes)]\n",
+                    argv[0]);
+            return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((cfg.keys == 0) || (cfg.ops == 0) || (cfg.window == 0) ||
+        (cfg.keys > INT_MAX / 2) || (cfg.window > INT_MAX / 4) ||
+        (cfg.ops > INT_MAX) || (cfg.theta <= 0.0) ||
+        (cfg.theta == 1.0) || (cfg.write_ratio < 0.0) ||
+        (cfg.write_ratio > 1.0)) {
+        fprintf(stderr, "Invalid parameters.\n");
+        return EXIT_FAILURE;
+    }
+    const char *workloads[] = {"uniform", "zipf", "sequential", "window",
+                               "mixed"};
+#ifdef SPLAY_ENABLE_PREFETCH
+    printf("Searches descend with prefetching.\n\n");
+#endif
+    int all = !strcmp(cfg.workload, "all");
+    int found = 0;
+    for (int w = 0; w < 5; w++) {
+        if (!all && strcmp(cfg.workload, workloads[w])) continue;
+        found = 1;
+        BenchConfig run_cfg = cfg;
+        run_cfg.workload = workloads[w];
+        int *prefill;
+        ulong prefill_count;
+        BenchOp *ops = bench_generate(&run_cfg, &prefill, &prefill_count);
+        if (ops == NULL) {
+            fprintf(stderr, "Failed to generate the workload.\n");
+            return EXIT_FAILURE;
+        }
+        printf("Workload: %s (%lu keys, %lu operations)\n", workloads[w],
+               prefill_count, run_cfg.ops);
+        printf("%-20s %12s %10s %10s %10s %10s %10s\n", "tree", "ops/s",
+               "p50 ns", "p99 ns", "p999 ns", "depth", "rot/op");
+        // Each target gets a fresh tree, filled in the same order.
+        for (int t = 0; t < 3; t++) {
+            BenchTarget target;
+            SplayIntTree *splay_tree = NULL;
+            BenchAVLNode *avl_root = NULL;
+            SplayIntPoolConfig pool_cfg = {0};
+            if (t < 2) {
+                splay_tree = create_splay_int_tree_ex(cfg.pooled ? &pool_cfg :
+                                                                   NULL);
+                if (splay_tree == NULL) return EXIT_FAILURE;
+                target.name = t ? "splay (search splay)" : "splay";
+                target.tree = splay_tree;
+                target.search = t ? bench_splay_search_splay :
+                                    bench_splay_search;
+                target.insert = bench_splay_insert;
+                target.remove = bench_splay_remove;
+            } else {
+                target.name = "avl";
+                target.tree = &avl_root;
+                target.search = bench_avl_search;
+                target.insert = bench_avl_insert;
+                target.remove = bench_avl_remove;
+            }
+            for (ulong i = 0; i < prefill_count; i++)
+                target.insert(target.tree, prefill[i]);
+            bench_run(&target, ops, run_cfg.ops, splay_tree);
+            if (splay_tree != NULL) delete_splay_int_tree(splay_tree, 0);
+            else bench_avl_free(avl_root);
+        }
+        printf("\n");
+        free(prefill);
+        free(ops);
+    }
+    if (!found) {
+        fprintf(stderr, "Unknown workload: %s\n", cfg.workload);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Runs a sequence of operations on a tree, timing each one of them, and
+ * prints the results.
+ *
+ * @param target Pointer to the tree to run the operations on.
+ * @param ops Pointer to the operations array.
+ * @param ops_count Number of operations to run.
+ * @param splay_tree Pointer to the Splay Tree under test, NULL if none.
+ */
+void bench_run(BenchTarget *target, const BenchOp *ops, ulong ops_count,
+               SplayIntTree *splay_tree) {
+    long long int *lat =
+        (long long int *)malloc(ops_count * sizeof(long long int));
+    if (lat == NULL) return;
+    SplayIntStats before, after;
+    int stats = (splay_tree != NULL) &&
+                (splay_int_stats(splay_tree, &before) == 0);
+    volatile void *sink = NULL;
+    long long int start = bench_now_ns();
+    long long int prev = start, now;
+    for (ulong i = 0; i < ops_count; i++) {
+        switch (ops[i].type) {
+        case BENCH_SEARCH:
+            sink = target->search(target->tree, ops[i].key);
+            break;
+        case BENCH_INSERT:
+            target->insert(target->tree, ops[i].key);
+            break;
+        default:
+            target->remove(target->tree, ops[i].key);
+            break;
+        }
+        now = bench_now_ns();
+        lat[i] = now - prev;
+        prev = now;
+    }
+    (void)sink;
+    double elapsed = (double)(prev - start) / 1e9;
+    qsort(lat, ops_count, sizeof(long long int), bench_compare_ns);
+    printf("%-20s %12.0f %10lld %10lld %10lld", target->name,
+           (double)ops_count / elapsed, lat[ops_count / 2],
+           lat[(ops_count * 99) / 100], lat[(ops_count * 999) / 1000]);
+    if (stats && (splay_int_stats(splay_tree, &after) == 0)) {
+        ulong descents = after.descents - before.descents;
+        printf(" %10.2f %10.2f\n",
+               descents ? (double)(after.depth_total - before.depth_total) /
+                          (double)descents : 0.0,
+               (double)(after.rotations - before.rotations) /
+               (double)ops_count);
+    } else printf(" %10s %10s\n", "-", "-");
+    free(lat);
+}
+
+/**
+ * Generates the operations of a workload, together with the keys to fill
+ * the trees with before running it.
+ *
+ * @param cfg Pointer to the benchmark configuration.
+ * @param prefill Pointer to the location to return the keys array into.
+ * @param prefill_count Pointer to the location to return the keys count into.
+ * @return Pointer to the operations array, NULL if allocation failed.
+ */
+BenchOp *bench_generate(const BenchConfig *cfg, int **prefill,
+                        ulong *prefill_count) {
+    ulong state = cfg->seed ? cfg->seed : 1;
+    int window = !strcmp(cfg->workload, "window");
+    ulong n = window ? cfg->window : cfg->keys;
+    BenchOp *ops = (BenchOp *)malloc(cfg->ops * sizeof(BenchOp));
+    int *keys = (int *)malloc(n * sizeof(int));
+    double *zipf_cdf = NULL;
+    if ((ops == NULL) || (keys == NULL)) {
+        free(ops);
+        free(keys);
+        return NULL;
+    }
+    // Keys are spread out and inserted in random order, so that trees don't
+    // start from a degenerate shape.
+    for (ulong i = 0; i < n; i++) keys[i] = (int)(i * 2);
+    if (!window) bench_shuffle(keys, n, &state);
+    if (!strcmp(cfg->workload, "zipf") || !strcmp(cfg->workload, "mixed")) {
+        // Ranks are mapped to keys through the shuffled keys array, so that
+        // hot keys are scattered in the tree.
+        zipf_cdf = (double *)malloc(n * sizeof(double));
+        if (zipf_cdf == NULL) {
+            free(ops);
+            free(keys);
+            return NULL;
+        }
+        double sum = 0.0;
+        for (ulong i = 0; i < n; i++) {
+            sum += 1.0 / pow((double)(i + 1), cfg->theta);
+            zipf_cdf[i] = sum;
+        }
+        for (ulong i = 0; i < n; i++) zipf_cdf[i] /= sum;
+    }
+    ulong next_key = n;
+    for (ulong i = 0; i < cfg->ops; i++) {
+        ops[i].type = BENCH_SEARCH;
+        if (zipf_cdf != NULL) {
+            // Look for the rank in the cumulative distribution.
+            double u = bench_rand_unit(&state);
+            ulong lo = 0, hi = n - 1;
+            while (lo < hi) {
+                ulong mid = lo + (hi - lo) / 2;
+                if (zipf_cdf[mid] < u) lo = mid + 1;
+                else hi = mid;
+            }
+            ops[i].key = keys[lo];
+            if (!strcmp(cfg->workload, "mixed") && (i + 1 < cfg->ops) &&
+                (bench_rand_unit(&state) < cfg->write_ratio)) {
+                // Updates delete and reinsert the key.
+                ops[i].type = BENCH_DELETE;
+                ops[i + 1].type = BENCH_INSERT;
+                ops[i + 1].key = keys[lo];
+                i++;
+            }
+        } else if (!strcmp(cfg->workload, "uniform")) {
+            ops[i].key = keys[bench_rand(&state) % n];
+        } else if (!strcmp(cfg->workload, "sequential")) {
+            ops[i].key = (int)((i % n) * 2);
+        } else {
+            // Slide the window one key forward every few searches of the
+            // most recent keys.
+            if ((i % 4 == 0) && (i + 1 < cfg->ops)) {
+                ops[i].type = BENCH_INSERT;
+                ops[i].key = (int)(next_key * 2);
+                ops[i + 1].type = BENCH_DELETE;
+                ops[i + 1].key = (int)((next_key - n) * 2);
+                next_key++;
+                i++;
+                continue;
+            }
+            ulong back = bench_rand(&state) % (n < 1024 ? n : 1024);
+            ops[i].key = (int)((next_key - 1 - back) * 2);
+        }
+    }
+    free(zipf_cdf);
+    *prefill = keys;
+    *prefill_count = n;
+    return ops;
+}
+
+/**
+ * Returns a pseudo-random number (xorshift64*).
+ *
+ * @param state Pointer to the generator state, must not be 0.
+ * @return A pseudo-random number.
+ */
+ulong bench_rand(ulong *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717UL;
+}
+
+/**
+ * Returns a pseudo-random number in [0, 1).
+ *
+ * @param state Pointer to the generator state, must not be 0.
+ * @return A pseudo-random number.
+ */
+double bench_rand_unit(ulong *state) {
+    return (double)(bench_rand(state) >> 11) / 9007199254740992.0;
+}
+
+/**
+ * Shuffles an array of keys (Fisher-Yates).
+ *
+ * @param keys Pointer to the keys array.
+ * @param n Number of keys.
+ * @param state Pointer to the generator state.
+ */
+void bench_shuffle(int *keys, ulong n, ulong *state) {
+    for (ulong i = n - 1; i > 0; i--) {
+        ulong j = bench_rand(state) % (i + 1);
+        int tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+/**
+ * Compares two latencies for qsort.
+ */
+int bench_compare_ns(const void *a, const void *b) {
+    long long int x = *(const long long int *)a;
+    long long int y = *(const long long int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Returns the current time from a monotonic clock.
+ *
+ * @return Current time in nanoseconds.
+ */
+long long int bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long int)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Splay Tree targets. */
+void *bench_splay_search(void *tree, int key) {
+    return splay_int_search((SplayIntTree *)tree, key, SEARCH_NODES);
+}
+
+void *bench_splay_search_splay(void *tree, int key) {
+    return splay_int_search((SplayIntTree *)tree, key,
+                            SEARCH_NODES | SEARCH_SPLAY);
+}
+
+void bench_splay_insert(void *tree, int key) {
+    splay_int_insert((SplayIntTree *)tree, key, NULL);
+}
+
+void bench_splay_remove(void *tree, int key) {
+    splay_int_delete((SplayIntTree *)tree, key, 0);
+}
+
+/* AVL tree targets, on a pointer to the root. */
+int bench_avl_height(BenchAVLNode *node) {
+    return (node != NULL) ? node->height : 0;
+}
+
+BenchAVLNode *bench_avl_fix(BenchAVLNode *node) {
+    int left = bench_avl_height(node->left);
+    int right = bench_avl_height(node->right);
+    node->height = 1 + ((left > right) ? left : right);
+    return node;
+}
+
+BenchAVLNode *bench_avl_rotate_right(BenchAVLNode *node) {
+    BenchAVLNode *left = node->left;
+    node->left = left->right;
+    left->right = bench_avl_fix(node);
+    return bench_avl_fix(left);
+}
+
+BenchAVLNode *bench_avl_rotate_left(BenchAVLNode *node) {
+    BenchAVLNode *right = node->right;
+    node->right = right->left;
+    right->left = bench_avl_fix(node);
+    return bench_avl_fix(right);
+}
+
+BenchAVLNode *bench_avl_balance(BenchAVLNode *node) {
+    bench_avl_fix(node);
+    int bal = bench_avl_height(node->left) - bench_avl_height(node->right);
+    if (bal > 1) {
+        if (bench_avl_height(node->left->left) <
+            bench_avl_height(node->left->right))
+            node->left = bench_avl_rotate_left(node->left);
+        return bench_avl_rotate_right(node);
+    }
+    if (bal < -1) {
+        if (bench_avl_height(node->right->right) <
+            bench_avl_height(node->right->left))
+            node->right = bench_avl_rotate_right(node->right);
+        return bench_avl_rotate_left(node);
+    }
+    return node;
+}
+
+BenchAVLNode *bench_avl_insert_node(BenchAVLNode *node, int key) {
+    if (node == NULL) {
+        BenchAVLNode *new_node = (BenchAVLNode *)malloc(sizeof(BenchAVLNode));
+        if (new_node == NULL) return NULL;
+        new_node->left = NULL;
+        new_node->right = NULL;
+        new_node->key = key;
+        new_node->height = 1;
+        new_node->data = NULL;
+        return new_node;
+    }
+    if (key < node->key) node->left = bench_avl_insert_node(node->left, key);
+    else node->right = bench_avl_insert_node(node->right, key);
+    return bench_avl_balance(node);
+}
+
+BenchAVLNode *bench_avl_remove_node(BenchAVLNode *node, int key) {
+    if (node == NULL) return NULL;
+    if (key < node->key) {
+        node->left = bench_avl_remove_node(node->left, key);
+    } else if (key > node->key) {
+        node->right = bench_avl_remove_node(node->right, key);
+    } else {
+        BenchAVLNode *left = node->left, *right = node->right;
+        free(node);
+        if (right == NULL) return left;
+        // Replace the node with its successor.
+        BenchAVLNode *min;
+        right = bench_avl_remove_min(right, &min);
+        min->right = right;
+        min->left = left;
+        return bench_avl_balance(min);
+    }
+    return bench_avl_balance(node);
+}
+
+BenchAVLNode *bench_avl_remove_min(BenchAVLNode *node, BenchAVLNode **min) {
+    if (node->left == NULL) {
+        *min = node;
+        return node->right;
+    }
+    node->left = bench_avl_remove_min(node->left, min);
+    return bench_avl_balance(node);
+}
+
+void bench_avl_free(BenchAVLNode *node) {
+    if (node == NULL) return;
+    bench_avl_free(node->left);
+    bench_avl_free(node->right);
+    free(node);
+}
+
+void *bench_avl_search(void *tree, int key) {
+    BenchAVLNode *curr = *(BenchAVLNode **)tree;
+    while ((curr != NULL) && (curr->key != key))
+        curr = (key < curr->key) ? curr->left : curr->right;
+    return curr;
+}
+
+void bench_avl_insert(void *tree, int key) {
+    *(BenchAVLNode **)tree = bench_avl_insert_node(*(BenchAVLNode **)tree, key);
+}
+
+void bench_avl_remove(void *tree, int key) {
+    *(BenchAVLNode **)tree = bench_avl_remove_node(*(BenchAVLNode **)tree, key);
+}
@@ -0,0 +1,211 @@
+/**
+ * @brief Splay Tree data structure library regression tests.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This program checks the library's behaviour in a few corner cases that
+ * once led to memory errors, so it's best built with sanitizers, e.g.:
+ *   gcc -g -fsanitize=address,undefined splay-trees_int-keys_test.c
+ *       splay-trees_int-keys.c -o splay-trees_int-keys_test -pthread
+ * It prints the outcome of each test, and exits with a failure status if
+ * any of them failed.
+ * Tests are:
+ * - Node pools shared by trees obtained from a split, which can't be moved
+ *   into another tree by joins and merges as long as both trees are alive,
+ *   but can as soon as one of them is deleted.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "splay-trees_int-keys.h"
+
+/* Test routines. */
+int test_merge_shared_pool(void);
+int test_merge_released_pool(void);
+int test_join_shared_pool(void);
+int test_join_released_pool(void);
+int test_join_split_siblings(void);
+
+/* Utility routines. */
+SplayIntTree *test_pooled_tree(int first, int last);
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} Test;
+
+int main(void) {
+    Test tests[] = {
+        {"merge with a shared pool", test_merge_shared_pool},
+        {"merge with a released pool", test_merge_released_pool},
+        {"join with a shared pool", test_join_shared_pool},
+        {"join with a released pool", test_join_released_pool},
+        {"join of split siblings", test_join_split_siblings}
+    };
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        int res = tests[i].run();
+        printf("%-32s %s\n", tests[i].name, res == 0 ? "ok" : "FAILED");
+        if (res != 0) failed++;
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Merging a tree into one with a different pool must fail while its own pool
+ * is shared with its split sibling, which must still work afterwards.
+ *
+ * @return 0 if all went well, -1 otherwise.
+ */
+int test_merge_shared_pool(void) {
+    SplayIntTree *tree = test_pooled_tree(0, 99);
+    SplayIntTree *other = test_pooled_tree(0, 99);
+    SplayIntTree *left = NULL, *right = NULL;
+    int res = -1;
+    if ((tree != NULL) && (other != NULL) &&
+        (splay_int_split(tree, 49, &left, &right) == 0)) {
+        tree = NULL;
+        if ((splay_int_merge(other, right, MERGE_KEEP_LEFT) == NULL) &&
+            (splay_int_insert(left, 1000, NULL) == 51) &&
+            (splay_int_insert(right, 1000, NULL) == 51)) res = 0;
+    }
+    delete_splay_int_tree(tree, 0);
+    delete_splay_int_tree(left, 0);
+    delete_splay_int_tree(right, 0);
+    delete_splay_int_tree(other, 0);
+    return res;
+}
+
+/**
+ * Once its split sibling is deleted, a tree can be merged into one with a
+ * different pool, which takes its nodes in.
+ *
+ * @return 0 if all went well, -1 otherwise.
+ */
+int test_merge_released_pool(void) {
+    SplayIntTree *tree = test_pooled_tree(0, 99);
+    SplayIntTree *other = test_pooled_tree(50, 149);
+    SplayIntTree *left = NULL, *right = NULL;
+    int res = -1;
+    if ((tree != NULL) && (other != NULL) &&
+        (splay_int_split(tree, 49, &left, &right) == 0)) {
+        tree = NULL;
+        delete_splay_int_tree(right, 0);
+        right = NULL;
+        if (splay_int_merge(other, left, MERGE_KEEP_LEFT) == other) {
+            left = NULL;
+            if ((other->nodes_count == 150) &&
+                (splay_int_insert(other, 1000, NULL) == 151)) res = 0;
+        }
+    }
+    delete_splay_int_tree(tree, 0);
+    delete_splay_int_tree(left, 0);
+    delete_splay_int_tree(right, 0);
+    delete_splay_int_tree(other, 0);
+    return res;
+}
+
+/**
+ * Joining a tree to one with a different pool must fail while its own pool is
+ * shared with its split sibling, which must still work afterwards.
+ *
+ * @return 0 if all went well, -1 otherwise.
+ */
+int test_join_shared_pool(void) {
+    SplayIntTree *tree = test_pooled_tree(0, 99);
+    SplayIntTree *other = test_pooled_tree(-100, -1);
+    SplayIntTree *left = NULL, *right = NULL;
+    int res = -1;
+    if ((tree != NULL) && (other != NULL) &&
+        (splay_int_split(tree, 49, &left, &right) == 0)) {
+        tree = NULL;
+        if ((splay_int_join(other, right) == NULL) &&
+            (splay_int_insert(left, 1000, NULL) == 51) &&
+            (splay_int_insert(right, 1000, NULL) == 51)) res = 0;
+    }
+    delete_splay_int_tree(tree, 0);
+    delete_splay_int_tree(left, 0);
+    delete_splay_int_tree(right, 0);
+    delete_splay_int_tree(other, 0);
+    return res;
+}
+
+/**
+ * Once its split sibling is deleted, a tree can be joined to one with a
+ * different pool, which takes its nodes in.
+ *
+ * @return 0 if all went well, -1 otherwise.
+ */
+int test_join_released_pool(void) {
+    SplayIntTree *tree = test_pooled_tree(0, 99);
+    SplayIntTree *other = test_pooled_tree(-100, -1);
+    SplayIntTree *left = NULL, *right = NULL;
+    int res = -1;
+    if ((tree != NULL) && (other != NULL) &&
+        (splay_int_split(tree, 49, &left, &right) == 0)) {
+        tree = NULL;
+        delete_splay_int_tree(left, 0);
+        left = NULL;
+        if (splay_int_join(other, right) == other) {
+            right = NULL;
+            if ((other->nodes_count == 150) &&
+                (splay_int_insert(other, 1000, NULL) == 151)) res = 0;
+        }
+    }
+    delete_splay_int_tree(tree, 0);
+    delete_splay_int_tree(left, 0);
+    delete_splay_int_tree(right, 0);
+    delete_splay_int_tree(other, 0);
+    return res;
+}
+
+/**
+ * Trees split from the same one can always be joined back, since they use
+ * the same pool.
+ *
+ * @return 0 if all went well, -1 otherwise.
+ */
+int test_join_split_siblings(void) {
+    SplayIntTree *tree = test_pooled_tree(0, 99);
+    SplayIntTree *left = NULL, *right = NULL;
+    int res = -1;
+    if ((tree != NULL) && (splay_int_split(tree, 49, &left, &right) == 0)) {
+        tree = NULL;
+        if (splay_int_join(left, right) == left) {
+            right = NULL;
+            if ((left->nodes_count == 100) &&
+                (splay_int_insert(left, 1000, NULL) == 101)) res = 0;
+        }
+    }
+    delete_splay_int_tree(tree, 0);
+    delete_splay_int_tree(left, 0);
+    delete_splay_int_tree(right, 0);
+    return res;
+}
+
+/**
+ * Creates a tree with a node pool, holding all keys in a given range.
+ *
+ * @param first First key to insert.
+ * @param last Last key to insert.
+ * @return Pointer to the new tree, or NULL if something failed.
+ */
+SplayIntTree *test_pooled_tree(int first, int last) {
+    SplayIntPoolConfig pool_cfg = {0};
+    SplayIntTree *tree = create_splay_int_tree_ex(&pool_cfg);
+    if (tree == NULL) return NULL;
+    for (int i = first; i <= last; i++) {
+        if (splay_int_insert(tree, i, NULL) == 0) {
+            delete_splay_int_tree(tree, 0);
+            return NULL;
+        }
+    }
+    return tree;
+}
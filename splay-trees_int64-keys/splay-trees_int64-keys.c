@@ -0,0 +1,26 @@
+/**
+ * @brief Splay Tree data structure library source code.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define SPL_TEMPLATE_KEEP_NAMES
+#include "splay-trees_int64-keys.h"
+
+/* Keys are stored as they are, and folded in half to be hashed. */
+#define SPL_KEY_MAKE(arg) (arg)
+#define SPL_KEY_GET(key) (key)
+#define SPL_KEY_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+#define SPL_KEY_HASH(key) \
+    ((unsigned int)((uint64_t)(key) ^ ((uint64_t)(key) >> 32)))
+#define SPL_KEY_FREE(key) ((void)(key))
+#define SPL_KEY_SPLIT(i, n) \
+    ((int64_t)(((uint64_t)1 << 63) + ((uint64_t)(i) + 1) * (UINT64_MAX / (n))))
+
+#include "../splay-trees_common/splay-trees_template.c"
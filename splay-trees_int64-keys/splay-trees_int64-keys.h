@@ -0,0 +1,48 @@
+/**
+ * @brief Splay Tree data structure library header.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file contains type definitions and declarations for the Splay Tree data
+ * structure. See the source file for brief descriptions of what each function
+ * does. Note that functions which names start with "_" are meant for internal
+ * use only, and only those without it should be used by the actual programmer.
+ * Many functions require dynamic memory allocation in the heap, and many
+ * exposed methods require pointers or return some which refer to the heap: see
+ * the source file to understand what needs to be freed after use.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef SPLAYTREES_INT64KEYS_H
+#define SPLAYTREES_INT64KEYS_H
+
+#include <stdint.h>
+#include "../splay-trees_common/splay-trees_common.h"
+
+/**
+ * In this flavour, 64-bit integers are used as keys in the dictionary.
+ * Types and functions are those of the template (see
+ * splay-trees_common/splay-trees_template.h), with "SplayInt64" and
+ * "splay_int64" in their names, e.g. SplayInt64Tree and splay_int64_search.
+ * Options are in splay-trees_common/splay-trees_common.h.
+ */
+#define SPL_TYPE_PREFIX SplayInt64
+#define SPL_FUNC_PREFIX splay_int64
+#define SPL_INTERNAL_PREFIX _spli64
+#define SPL_KEY int64_t
+#define SPL_KEY_ARG int64_t
+#define SPL_KEY_PLAIN
+
+#include "../splay-trees_common/splay-trees_names.h"
+#include "../splay-trees_common/splay-trees_template.h"
+#ifndef SPL_TEMPLATE_KEEP_NAMES
+#include "../splay-trees_common/splay-trees_undef.h"
+#endif
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @brief Splay Tree data structure library source code.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <string.h>
+#define SPL_TEMPLATE_KEEP_NAMES
+#include "splay-trees_str-keys.h"
+
+/**
+ * Builds a key to store from a string, caching its first bytes (see header).
+ * Bytes are packed from the most significant one, so that comparing prefixes
+ * as unsigned integers is the same as comparing their bytes as strcmp does.
+ *
+ * @param str String to build the key of.
+ * @return Key to store.
+ */
+static inline SplayStrKey _spls_key_make(char *str) {
+    SplayStrKey key = {0, str};
+    for (int i = 0; (i < 8) && (str[i] != '\0'); i++)
+        key._prefix |= (uint64_t)(unsigned char)str[i] << (56 - (8 * i));
+    return key;
+}
+
+/**
+ * Compares two stored keys, reading their strings only if their cached
+ * prefixes are the same and both go on past them.
+ *
+ * @param a First key.
+ * @param b Second key.
+ * @return Negative, zero or positive if a is less than, equal to or greater
+ *         than b.
+ */
+static inline int _spls_key_compare(SplayStrKey a, SplayStrKey b) {
+    if (a._prefix != b._prefix) return (a._prefix > b._prefix) ? 1 : -1;
+    // If the prefixes hold the whole strings, these are equal.
+    if ((a._prefix & 0xFF) == 0) return 0;
+    return strcmp(a._str + 8, b._str + 8);
+}
+
+/**
+ * Hashes a stored key with FNV-1a, walking its whole string, so that strings
+ * with the same prefix are spread among shards too.
+ *
+ * @param key Key to hash.
+ * @return 32-bit hash of the key.
+ */
+static inline unsigned int _spls_key_hash(SplayStrKey key) {
+    unsigned int hash = 2166136261U;
+    for (const char *c = key._str; *c != '\0'; c++)
+        hash = (hash ^ (unsigned char)*c) * 16777619U;
+    return hash;
+}
+
+/* There's no way to split strings evenly, so SPL_KEY_SPLIT is not there. */
+#define SPL_KEY_MAKE(arg) _spls_key_make(arg)
+#define SPL_KEY_GET(key) ((key)._str)
+#define SPL_KEY_CMP(a, b) _spls_key_compare(a, b)
+#define SPL_KEY_HASH(key) _spls_key_hash(key)
+#define SPL_KEY_FREE(key) free((key)._str)
+
+#include "../splay-trees_common/splay-trees_template.c"
@@ -0,0 +1,61 @@
+/**
+ * @brief Splay Tree data structure library header.
+ *
+ * @author Roberto Masocco
+ *
+ * @date April 4, 2021
+ */
+/**
+ * This file contains type definitions and declarations for the Splay Tree data
+ * structure. See the source file for brief descriptions of what each function
+ * does. Note that functions which names start with "_" are meant for internal
+ * use only, and only those without it should be used by the actual programmer.
+ * Many functions require dynamic memory allocation in the heap, and many
+ * exposed methods require pointers or return some which refer to the heap: see
+ * the source file to understand what needs to be freed after use.
+ */
+/**
+ * This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef SPLAYTREES_STRINGKEYS_H
+#define SPLAYTREES_STRINGKEYS_H
+
+#include <stdint.h>
+#include "../splay-trees_common/splay-trees_common.h"
+
+/**
+ * In this flavour, NUL-terminated strings are used as keys in the dictionary,
+ * compared as strcmp does.
+ * Types and functions are those of the template (see
+ * splay-trees_common/splay-trees_template.h), with "SplayStr" and
+ * "splay_str" in their names, e.g. SplayStrTree and splay_str_search.
+ * Options are in splay-trees_common/splay-trees_common.h.
+ * Trees store pointers to the strings they're given, which then belong to
+ * them: strings must not be modified while they're in a tree, and can be
+ * freed together with their nodes with DELETE_FREE_KEYS. Strings given as
+ * bounds of sharded trees must outlive them.
+ * Each node caches the first 8 bytes of its key (padded with zeros) in an
+ * integer, packed so that integers compare like the strings they come from,
+ * so that most comparisons never read the strings. Since the range of keys
+ * can't be split evenly, sharded trees by range require bounds.
+ */
+typedef struct {
+    uint64_t _prefix;
+    char *_str;
+} SplayStrKey;
+
+#define SPL_TYPE_PREFIX SplayStr
+#define SPL_FUNC_PREFIX splay_str
+#define SPL_INTERNAL_PREFIX _spls
+#define SPL_KEY SplayStrKey
+#define SPL_KEY_ARG char *
+
+#include "../splay-trees_common/splay-trees_names.h"
+#include "../splay-trees_common/splay-trees_template.h"
+#ifndef SPL_TEMPLATE_KEEP_NAMES
+#include "../splay-trees_common/splay-trees_undef.h"
+#endif
+
+#endif